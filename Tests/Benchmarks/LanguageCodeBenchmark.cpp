@@ -0,0 +1,140 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "LanguageCode.h"
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+    // The find/substr conversions UserPreferences used before LanguageCode.h, kept as the baseline
+    bool LegacyToPresentation(const std::string& uiLanguage, std::string& presentationLanguage)
+    {
+        size_t sep = uiLanguage.find('_');
+        if (sep == 2 && uiLanguage.length() == 5) {
+            presentationLanguage = uiLanguage.substr(sep + 1) + "-" + uiLanguage.substr(0, sep);
+            return true;
+        }
+        return false;
+    }
+
+    bool LegacyToUI(const std::string& presentationLanguage, std::string& uiLanguage)
+    {
+        size_t sep = presentationLanguage.find('-');
+        if (sep == 2 && presentationLanguage.length() == 5) {
+            uiLanguage = presentationLanguage.substr(sep + 1) + "_" + presentationLanguage.substr(0, sep);
+            return true;
+        }
+        return false;
+    }
+
+    // Same calling convention as UserPreferences::ConvertTo*Format: std::string in, std::string out
+    bool TableToPresentation(const std::string& uiLanguage, std::string& presentationLanguage)
+    {
+        char converted[LanguageCode::BUFFER_SIZE];
+        if (LanguageCode::ToPresentation(uiLanguage.c_str(), uiLanguage.length(), converted)) {
+            presentationLanguage.assign(converted, LanguageCode::CODE_LENGTH);
+            return true;
+        }
+        return false;
+    }
+
+    bool TableToUI(const std::string& presentationLanguage, std::string& uiLanguage)
+    {
+        char converted[LanguageCode::BUFFER_SIZE];
+        if (LanguageCode::ToUI(presentationLanguage.c_str(), presentationLanguage.length(), converted)) {
+            uiLanguage.assign(converted, LanguageCode::CODE_LENGTH);
+            return true;
+        }
+        return false;
+    }
+
+    const std::string UILanguages[] = { "US_en", "CA_fr", "DE_de", "GB_en", "JP_ja", "BR_pt", "ZA_zu", "AD_ca" };
+    const std::string PresentationLanguages[] = { "en-US", "fr-CA", "de-DE", "en-GB", "ja-JP", "pt-BR", "zu-ZA", "ca-AD" };
+    constexpr size_t SAMPLES = sizeof(UILanguages) / sizeof(UILanguages[0]);
+
+} // namespace
+
+static void BM_LegacyToPresentation(benchmark::State& state)
+{
+    std::string output;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LegacyToPresentation(UILanguages[index++ % SAMPLES], output));
+    }
+}
+BENCHMARK(BM_LegacyToPresentation);
+
+static void BM_TableToPresentation(benchmark::State& state)
+{
+    std::string output;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TableToPresentation(UILanguages[index++ % SAMPLES], output));
+    }
+}
+BENCHMARK(BM_TableToPresentation);
+
+static void BM_LegacyToUI(benchmark::State& state)
+{
+    std::string output;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(LegacyToUI(PresentationLanguages[index++ % SAMPLES], output));
+    }
+}
+BENCHMARK(BM_LegacyToUI);
+
+static void BM_TableToUI(benchmark::State& state)
+{
+    std::string output;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TableToUI(PresentationLanguages[index++ % SAMPLES], output));
+    }
+}
+BENCHMARK(BM_TableToUI);
+
+// The raw converter on caller buffers, without the std::string wrapping
+static void BM_TableToUIBuffer(benchmark::State& state)
+{
+    char output[LanguageCode::BUFFER_SIZE];
+    size_t index = 0;
+    for (auto _ : state) {
+        const std::string& input = PresentationLanguages[index++ % SAMPLES];
+        benchmark::DoNotOptimize(LanguageCode::ToUI(input.c_str(), input.length(), output));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_TableToUIBuffer);
+
+static void BM_TableToUIExtendedForms(benchmark::State& state)
+{
+    static const std::string inputs[] = { "eng-US", "zh-Hans-CN", "ger-DE", "sr-Latn-RS" };
+    std::string output;
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TableToUI(inputs[index++ % 4], output));
+    }
+}
+BENCHMARK(BM_TableToUIExtendedForms);
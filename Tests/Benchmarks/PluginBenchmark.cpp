@@ -0,0 +1,455 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+* Request path benchmarks for the UserPreferences plugin.
+*
+* The plugin runs in-process against the entservices-testframework UserSettingMock.
+* The benchmark argument is the latency (in microseconds) every UserSettings call
+* takes, standing in for the COM-RPC round trip to the out-of-process UserSettings.
+* The preferences file lives in USERPREFERENCES_BENCHMARK_DIR (default /dev/shm) so
+* persistence is measured without the storage device.
+*
+* Run with --benchmark_out=<file> --benchmark_out_format=json for machine readable results.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <list>
+#include <thread>
+#include <unistd.h>
+
+#include "UserSettingMock.h"
+#include "ServiceMock.h"
+#include "COMLinkMock.h"
+#include "UserPreferences.h"
+#include "UserPreferencesImplementation.h"
+#include "PreferenceStore.h"
+#include "ViewingRestrictions.h"
+#include "ThunderPortability.h"
+#include "WorkerPoolImplementation.h"
+
+using namespace WPEFramework;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace {
+
+    const string UserSettingsCallsign = _T("org.rdk.UserSettings");
+
+    string BenchmarkDirectory()
+    {
+        const char* directory = ::getenv("USERPREFERENCES_BENCHMARK_DIR");
+        return ((directory != nullptr) && (directory[0] != '\0')) ? string(directory) : string(_T("/dev/shm"));
+    }
+
+    string PreferencesFile()
+    {
+        return (BenchmarkDirectory() + _T("/user_preferences_benchmark.conf"));
+    }
+
+    void InjectLatency(const std::chrono::microseconds latency)
+    {
+        if (latency.count() > 0) {
+            std::this_thread::sleep_for(latency);
+        }
+    }
+
+    // Presentation languages cycled through by the set and notification benchmarks
+    const string PresentationLanguages[] = { _T("en-US"), _T("fr-CA"), _T("de-DE"), _T("en-GB") };
+    const string UILanguages[] = { _T("US_en"), _T("CA_fr"), _T("DE_de"), _T("GB_en") };
+    constexpr size_t LANGUAGES = sizeof(UILanguages) / sizeof(UILanguages[0]);
+
+    // A week of 30 minute slots on 24 channels, as an EPG grid asks isContentAllowed about
+    constexpr uint32_t EPG_ENTRIES = 7 * 48 * 24;
+    constexpr int64_t EPG_START = 1767225600;
+    const TCHAR* const EpgRatings[] = { _T("TV-Y"), _T("TV-G"), _T("TV-PG"), _T("TV-14"), _T("TV-MA") };
+    const string EpgRestrictions = _T("{\"restrictions\":[{\"scheme\":\"US_TV\",\"restrict\":[\"TV-14\",\"TV-MA\",\"TV-PG/V/S\"]}]}");
+
+    // V and D on every third entry, L and D on the others
+    uint32_t EpgDescriptors(const uint32_t index)
+    {
+        return (((index % 3) == 0 ? Exchange::IUserPreferences::DESCRIPTOR_VIOLENCE : Exchange::IUserPreferences::DESCRIPTOR_LANGUAGE)
+            | Exchange::IUserPreferences::DESCRIPTOR_DIALOGUE);
+    }
+
+} // namespace
+
+class UserPreferencesFixture : public benchmark::Fixture {
+public:
+    UserPreferencesFixture()
+        : _plugin()
+        , _implementation()
+        , _handler(nullptr)
+        , INIT_CONX(1, 0)
+        , _service(nullptr)
+        , _comLink(nullptr)
+        , _userSettings(nullptr)
+        , _pluginSink(nullptr)
+        , _userSettingsSink(nullptr)
+        , _presentationLanguage(_T("en-US"))
+        , _latency(0)
+    {
+    }
+
+    void SetUp(const benchmark::State& state) override
+    {
+        _latency = std::chrono::microseconds(state.range(0));
+        _presentationLanguage = _T("en-US");
+        ::unlink(PreferencesFile().c_str());
+
+        _service = new NiceMock<ServiceMock>;
+        _comLink = new NiceMock<COMLinkMock>;
+        _userSettings = new NiceMock<UserSettingMock>;
+
+        // In-process implementation, so the numbers exclude the COM-RPC hop of the out-of-process mode
+        ON_CALL(*_service, COMLink())
+            .WillByDefault(Return(_comLink));
+        ON_CALL(*_comLink, Instantiate(::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault([this](const RPC::Object&, const uint32_t, uint32_t& connectionId) -> void* {
+                connectionId = 0;
+                _implementation = Core::ProxyType<Plugin::UserPreferencesImplementation>::Create();
+                Exchange::IUserPreferences* implementation = &(*_implementation);
+                implementation->AddRef();
+                return implementation;
+            });
+
+        ON_CALL(*_service, ConfigLine())
+            .WillByDefault(Return(string(_T("{\"persistdelay\":0,\"fsync\":\"data\",\"path\":\"")) + PreferencesFile() + _T("\"}")));
+        ON_CALL(*_service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
+            .WillByDefault(Return(_userSettings));
+        ON_CALL(*_service, Register(::testing::A<PluginHost::IPlugin::INotification*>()))
+            .WillByDefault([this](PluginHost::IPlugin::INotification* sink) { _pluginSink = sink; });
+
+        ON_CALL(*_userSettings, Register(::testing::_))
+            .WillByDefault([this](Exchange::IUserSettings::INotification* sink) {
+                _userSettingsSink = sink;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetMigrationState(::testing::_, ::testing::_))
+            .WillByDefault([this](const Exchange::IUserSettingsInspector::SettingsKey, bool& requiresMigration) {
+                InjectLatency(_latency);
+                requiresMigration = false;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetPresentationLanguage(::testing::_))
+            .WillByDefault([this](string& language) {
+                InjectLatency(_latency);
+                language = _presentationLanguage;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, SetPresentationLanguage(::testing::_))
+            .WillByDefault([this](const string& language) {
+                InjectLatency(_latency);
+                _presentationLanguage = language;
+                return Core::ERROR_NONE;
+            });
+
+        _plugin = Core::ProxyType<Plugin::UserPreferences>::Create();
+        _handler = &(*_plugin);
+        _plugin->Initialize(_service);
+
+        // What Thunder reports once UserSettings is up; starts the migration thread
+        if (_pluginSink != nullptr) {
+            _pluginSink->Activated(UserSettingsCallsign, nullptr);
+        }
+
+        // Wait for the migration so every benchmark starts from the steady state
+        string response;
+        _handler->Invoke(connection, _T("getUILanguage"), _T("{}"), response);
+    }
+
+    void TearDown(const benchmark::State&) override
+    {
+        _plugin->Deinitialize(_service);
+        _plugin.Release();
+        _implementation.Release();
+        _handler = nullptr;
+        _pluginSink = nullptr;
+        _userSettingsSink = nullptr;
+
+        delete _userSettings;
+        delete _comLink;
+        delete _service;
+        _userSettings = nullptr;
+        _comLink = nullptr;
+        _service = nullptr;
+        ::unlink(PreferencesFile().c_str());
+    }
+
+protected:
+    // Viewing restrictions of the EPG benchmarks, read once by the first request
+    void RestrictEpg()
+    {
+        ON_CALL(*_userSettings, GetPinControl(::testing::_))
+            .WillByDefault([](bool& pinControl) {
+                pinControl = true;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetViewingRestrictions(::testing::_))
+            .WillByDefault([](string& viewingRestrictions) {
+                viewingRestrictions = EpgRestrictions;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetViewingRestrictionsWindow(::testing::_))
+            .WillByDefault([](string& window) {
+                window = _T("06:00-21:00");
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetLiveWatershed(::testing::_))
+            .WillByDefault([](bool& liveWatershed) {
+                liveWatershed = true;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetPlaybackWatershed(::testing::_))
+            .WillByDefault([](bool& playbackWatershed) {
+                playbackWatershed = false;
+                return Core::ERROR_NONE;
+            });
+        ON_CALL(*_userSettings, GetBlockNotRatedContent(::testing::_))
+            .WillByDefault([](bool& blockNotRatedContent) {
+                blockNotRatedContent = false;
+                return Core::ERROR_NONE;
+            });
+    }
+
+protected:
+    Core::ProxyType<Plugin::UserPreferences> _plugin;
+    Core::ProxyType<Plugin::UserPreferencesImplementation> _implementation;
+    Core::JSONRPC::Handler* _handler;
+    DECL_CORE_JSONRPC_CONX connection;
+    NiceMock<ServiceMock>* _service;
+    NiceMock<COMLinkMock>* _comLink;
+    NiceMock<UserSettingMock>* _userSettings;
+    PluginHost::IPlugin::INotification* _pluginSink;
+    Exchange::IUserSettings::INotification* _userSettingsSink;
+    string _presentationLanguage;
+    std::chrono::microseconds _latency;
+};
+
+// Steady state: answered from the notification-fed cache, UserSettings is not called
+BENCHMARK_DEFINE_F(UserPreferencesFixture, GetUILanguageCached)(benchmark::State& state)
+{
+    string response;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(_handler->Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    }
+}
+BENCHMARK_REGISTER_F(UserPreferencesFixture, GetUILanguageCached)->Arg(0)->Arg(100)->Arg(1000);
+
+// Cold path: UserSettings was deactivated, so every request re-acquires it and reads the live value
+BENCHMARK_DEFINE_F(UserPreferencesFixture, GetUILanguageUncached)(benchmark::State& state)
+{
+    string response;
+    for (auto _ : state) {
+        state.PauseTiming();
+        if (_pluginSink != nullptr) {
+            _pluginSink->Deactivated(UserSettingsCallsign, nullptr);
+        }
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(_handler->Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    }
+}
+BENCHMARK_REGISTER_F(UserPreferencesFixture, GetUILanguageUncached)->Arg(0)->Arg(100)->Arg(1000);
+
+BENCHMARK_DEFINE_F(UserPreferencesFixture, SetUILanguage)(benchmark::State& state)
+{
+    string response;
+    string parameters[LANGUAGES];
+    for (size_t index = 0; index < LANGUAGES; index++) {
+        parameters[index] = _T("{\"ui_language\":\"") + UILanguages[index] + _T("\"}");
+    }
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(_handler->Invoke(connection, _T("setUILanguage"), parameters[index++ % LANGUAGES], response));
+    }
+}
+BENCHMARK_REGISTER_F(UserPreferencesFixture, SetUILanguage)->Arg(0)->Arg(100)->Arg(1000);
+
+// The UserSettings notification callback, which only queues the value for the notification job
+BENCHMARK_DEFINE_F(UserPreferencesFixture, OnPresentationLanguageChanged)(benchmark::State& state)
+{
+    if (_userSettingsSink == nullptr) {
+        state.SkipWithError("UserSettings notification sink not registered");
+        return;
+    }
+    size_t index = 0;
+    for (auto _ : state) {
+        _userSettingsSink->OnPresentationLanguageChanged(PresentationLanguages[index++ % LANGUAGES]);
+    }
+}
+BENCHMARK_REGISTER_F(UserPreferencesFixture, OnPresentationLanguageChanged)->Arg(0);
+
+// End to end: JSON-RPC parameters, parsing the grid, evaluation and encoding the bitmap
+BENCHMARK_DEFINE_F(UserPreferencesFixture, IsContentAllowedEpgGrid)(benchmark::State& state)
+{
+    RestrictEpg();
+
+    string request = _T("{\"content\":[");
+    for (uint32_t index = 0; index < EPG_ENTRIES; index++) {
+        request += (index == 0 ? _T("{\"scheme\":\"US_TV\",\"rating\":\"") : _T(",{\"scheme\":\"US_TV\",\"rating\":\""));
+        request += EpgRatings[index % 5];
+        request += _T("\",\"descriptorMask\":");
+        request += std::to_string(EpgDescriptors(index));
+        request += _T(",\"airingTime\":");
+        request += std::to_string(EPG_START + ((index / 24) * 1800));
+        request += _T("}");
+    }
+    request += _T("]}");
+
+    // Compiles the rules, so the loop measures the steady state
+    string response;
+    if (Core::ERROR_NONE != _handler->Invoke(connection, _T("isContentAllowed"), request, response)) {
+        state.SkipWithError("isContentAllowed failed");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(_handler->Invoke(connection, _T("isContentAllowed"), request, response));
+    }
+    state.SetItemsProcessed(state.iterations() * EPG_ENTRIES);
+}
+BENCHMARK_REGISTER_F(UserPreferencesFixture, IsContentAllowedEpgGrid)->Arg(0)->Unit(benchmark::kMicrosecond);
+
+// End to end over COM: building the iterator as a caller would, draining it, evaluation and encoding the bitmap
+BENCHMARK_DEFINE_F(UserPreferencesFixture, IsContentAllowedEpgGridCom)(benchmark::State& state)
+{
+    RestrictEpg();
+
+    std::list<Exchange::IUserPreferences::Content> grid;
+    for (uint32_t index = 0; index < EPG_ENTRIES; index++) {
+        grid.push_back({ _T("US_TV"), EpgRatings[index % 5], EpgDescriptors(index), EPG_START + ((index / 24) * 1800) });
+    }
+
+    Exchange::IUserPreferences* userPreferences = _plugin->QueryInterface<Exchange::IUserPreferences>();
+    if (userPreferences == nullptr) {
+        state.SkipWithError("IUserPreferences not available");
+        return;
+    }
+    string allowed;
+    bool success = false;
+    // Compiles the rules, so the loop measures the steady state
+    Exchange::IUserPreferences::IContentIterator* first = Core::Service<RPC::IteratorType<Exchange::IUserPreferences::IContentIterator>>::Create<Exchange::IUserPreferences::IContentIterator>(grid);
+    const Core::hresult result = userPreferences->IsContentAllowed(first, allowed, success);
+    first->Release();
+    if (Core::ERROR_NONE != result) {
+        userPreferences->Release();
+        state.SkipWithError("IsContentAllowed failed");
+        return;
+    }
+    for (auto _ : state) {
+        Exchange::IUserPreferences::IContentIterator* content = Core::Service<RPC::IteratorType<Exchange::IUserPreferences::IContentIterator>>::Create<Exchange::IUserPreferences::IContentIterator>(grid);
+        benchmark::DoNotOptimize(userPreferences->IsContentAllowed(content, allowed, success));
+        content->Release();
+    }
+    userPreferences->Release();
+    state.SetItemsProcessed(state.iterations() * EPG_ENTRIES);
+}
+BENCHMARK_REGISTER_F(UserPreferencesFixture, IsContentAllowedEpgGridCom)->Arg(0)->Unit(benchmark::kMicrosecond);
+
+// The compiled evaluator alone, on entries that are already parsed
+static void BM_ViewingRestrictionsEvaluate(benchmark::State& state)
+{
+    Plugin::ViewingRestrictions restrictions;
+    restrictions.Update(Plugin::SettingsCache::PIN_CONTROL, JsonValue(true));
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS, JsonValue(EpgRestrictions));
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS_WINDOW, JsonValue(_T("06:00-21:00")));
+    restrictions.Update(Plugin::SettingsCache::LIVE_WATERSHED, JsonValue(true));
+    restrictions.Update(Plugin::SettingsCache::PLAYBACK_WATERSHED, JsonValue(false));
+    restrictions.Update(Plugin::SettingsCache::BLOCK_NOT_RATED_CONTENT, JsonValue(false));
+
+    std::vector<Plugin::ViewingRestrictions::Content> grid;
+    for (uint32_t index = 0; index < EPG_ENTRIES; index++) {
+        grid.push_back({ _T("US_TV"), EpgRatings[index % 5], EpgDescriptors(index), EPG_START + ((index / 24) * 1800) });
+    }
+    std::vector<uint8_t> allowed;
+    for (auto _ : state) {
+        restrictions.Evaluate(grid.data(), grid.size(), EPG_START, allowed);
+        benchmark::DoNotOptimize(allowed.data());
+    }
+    state.SetItemsProcessed(state.iterations() * EPG_ENTRIES);
+}
+BENCHMARK(BM_ViewingRestrictionsEvaluate)->Unit(benchmark::kMicrosecond);
+
+// File persistence, changed value: render, compare, write the temporary file, sync and rename
+static void BM_PreferenceStoreWrite(benchmark::State& state)
+{
+    Plugin::PreferenceStore store(_T("General"));
+    store.Configure(PreferencesFile(), static_cast<Plugin::PreferenceStore::FsyncPolicy>(state.range(0)));
+    size_t index = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Set(_T("ui_language"), UILanguages[index++ % LANGUAGES]));
+    }
+    ::unlink(PreferencesFile().c_str());
+}
+BENCHMARK(BM_PreferenceStoreWrite)
+    ->Arg(static_cast<int>(Plugin::PreferenceStore::FsyncPolicy::NONE))
+    ->Arg(static_cast<int>(Plugin::PreferenceStore::FsyncPolicy::DATA))
+    ->Arg(static_cast<int>(Plugin::PreferenceStore::FsyncPolicy::FULL));
+
+// File persistence, unchanged value: the compare short-circuits the write
+static void BM_PreferenceStoreUnchanged(benchmark::State& state)
+{
+    Plugin::PreferenceStore store(_T("General"));
+    store.Configure(PreferencesFile(), Plugin::PreferenceStore::FsyncPolicy::DATA);
+    store.Set(_T("ui_language"), UILanguages[0]);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Set(_T("ui_language"), UILanguages[0]));
+    }
+    ::unlink(PreferencesFile().c_str());
+}
+BENCHMARK(BM_PreferenceStoreUnchanged);
+
+static void BM_PreferenceStoreRead(benchmark::State& state)
+{
+    Plugin::PreferenceStore store(_T("General"));
+    store.Configure(PreferencesFile(), Plugin::PreferenceStore::FsyncPolicy::NONE);
+    store.Set(_T("ui_language"), UILanguages[0]);
+    string value;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(store.Get(_T("ui_language"), value));
+    }
+    ::unlink(PreferencesFile().c_str());
+}
+BENCHMARK(BM_PreferenceStoreRead);
+
+int main(int argc, char** argv)
+{
+    // The plugin runs its write-behind, event and notification jobs on the worker pool
+    Core::ProxyType<WorkerPoolImplementation> workerPool = Core::ProxyType<WorkerPoolImplementation>::Create(
+        2, Core::Thread::DefaultStackSize(), 16);
+    Core::IWorkerPool::Assign(&(*workerPool));
+    workerPool->Run();
+
+    benchmark::Initialize(&argc, argv);
+    int result = 0;
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        result = 1;
+    } else {
+        benchmark::RunSpecifiedBenchmarks();
+        benchmark::Shutdown();
+    }
+
+    Core::IWorkerPool::Assign(nullptr);
+    workerPool.Release();
+    Core::Singleton::Dispose();
+
+    return result;
+}
@@ -0,0 +1,163 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+/**
+* Benchmarks for the file helpers of helpers/UtilsFile.h on multi-MB input, about the size of a
+* rotated log or a verbose command output. Correctness is covered by the L1 tests.
+*
+* MoveFile across file systems moves from /tmp to /dev/shm, and is skipped where both are on one.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "Module.h"
+#include "UtilsFile.h"
+
+namespace {
+
+    constexpr size_t BENCHMARK_BYTES = 32 * 1024 * 1024;
+
+    const string OutputFile = _T("/tmp/UtilsFileBenchmark.output");
+
+    bool CreateFile(const string& name)
+    {
+        static std::vector<uint8_t> content;
+        if (content.empty()) {
+            content.resize(BENCHMARK_BYTES);
+            for (size_t index = 0; index < content.size(); index++) {
+                content[index] = static_cast<uint8_t>((index * 131) ^ (index >> 12));
+            }
+        }
+        std::ofstream file(name, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(content.data()), content.size());
+        return file.good();
+    }
+
+    // One MoveFile per iteration; the file is created and removed outside of the timing
+    void MoveFiles(benchmark::State& state, const string& from, const string& to)
+    {
+        for (auto _ : state) {
+            state.PauseTiming();
+            ::unlink(to.c_str());
+            if (!CreateFile(from)) {
+                state.SkipWithError("Creating the source file failed");
+                break;
+            }
+            state.ResumeTiming();
+            if (!Utils::MoveFile(from, to)) {
+                state.SkipWithError("MoveFile failed");
+                break;
+            }
+        }
+        state.SetBytesProcessed(state.iterations() * BENCHMARK_BYTES);
+        ::unlink(from.c_str());
+        ::unlink(to.c_str());
+    }
+
+    // Many short lines, as a command writes them
+    const string& CommandOutput()
+    {
+        static string output;
+        if (output.empty()) {
+            output.reserve(BENCHMARK_BYTES + 64);
+            for (uint32_t index = 0; output.size() < BENCHMARK_BYTES; index++) {
+                output += _T("line ") + std::to_string(index) + _T(" of the command output\r\n");
+            }
+            output += _T("last line\n");
+        }
+        return output;
+    }
+
+    // The implementation getLastLine replaced, as the reference
+    bool StreamLastLine(const string& input, string& res_str)
+    {
+        string read_line;
+        bool ret_value = false;
+        std::stringstream read_str(input);
+        while (getline(read_str, read_line, '\n')) {
+            if (!read_line.empty()) {
+                res_str = read_line;
+                ret_value = true;
+            }
+        }
+        return ret_value;
+    }
+
+} // namespace
+
+static void BM_GetLastLineStream(benchmark::State& state)
+{
+    const string& output = CommandOutput();
+    string line;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(StreamLastLine(output, line));
+    }
+    state.SetBytesProcessed(state.iterations() * output.size());
+}
+BENCHMARK(BM_GetLastLineStream)->Unit(benchmark::kMillisecond);
+
+static void BM_GetLastLine(benchmark::State& state)
+{
+    const string& output = CommandOutput();
+    string line;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utils::getLastLine(output, line));
+    }
+    state.SetBytesProcessed(state.iterations() * output.size());
+}
+BENCHMARK(BM_GetLastLine)->Unit(benchmark::kMicrosecond);
+
+static void BM_GetLastLineOfFile(benchmark::State& state)
+{
+    {
+        std::ofstream file(OutputFile, std::ios::binary | std::ios::trunc);
+        file << CommandOutput();
+    }
+    string line;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Utils::getLastLineOfFile(OutputFile, line));
+    }
+    ::unlink(OutputFile.c_str());
+}
+BENCHMARK(BM_GetLastLineOfFile)->Unit(benchmark::kMicrosecond);
+
+// rename(2): only the directory entry changes
+static void BM_MoveFileSameFileSystem(benchmark::State& state)
+{
+    MoveFiles(state, _T("/tmp/UtilsFileBenchmark.move"), _T("/tmp/UtilsFileBenchmark.moved"));
+}
+BENCHMARK(BM_MoveFileSameFileSystem)->Unit(benchmark::kMicrosecond);
+
+// The copy in the kernel, as rename(2) can't cross file systems
+static void BM_MoveFileAcrossFileSystems(benchmark::State& state)
+{
+    struct stat source, destination;
+    if ((::stat("/tmp", &source) != 0) || (::stat("/dev/shm", &destination) != 0) || (source.st_dev == destination.st_dev)) {
+        state.SkipWithError("/tmp and /dev/shm are not on different file systems");
+        return;
+    }
+    MoveFiles(state, _T("/tmp/UtilsFileBenchmark.move"), _T("/dev/shm/UtilsFileBenchmark.moved"));
+}
+BENCHMARK(BM_MoveFileAcrossFileSystems)->Unit(benchmark::kMillisecond);
@@ -23,15 +23,23 @@
 #include <gtest/gtest.h>
 #include <mntent.h>
 #include <fstream>
+#include <functional>
 #include <algorithm>
 #include <string>
+#include <list>
 #include <vector>
 #include <cstdio>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <limits>
 #include "UserSettingMock.h"
 #include "ServiceMock.h"
 #include "UserPreferences.h"
+#include "UserPreferencesImplementation.h"
 #include "ThunderPortability.h"
 #include "COMLinkMock.h"
+#include "WorkerPoolImplementation.h"
 //#include "WrapsMock.h"
 
 #define TEST_LOG(x, ...) fprintf(stderr, "\033[1;32m[%s:%d](%s)<PID:%d><TID:%d>" x "\n\033[0m", __FILE__, __LINE__, __FUNCTION__, getpid(), gettid(), ##__VA_ARGS__); fflush(stderr);
@@ -43,18 +51,35 @@ using ::testing::Return;
 namespace {
 const string userPrefFile = _T("/opt/user_preferences.conf");
 const uint8_t userPrefLang[] = "[General]\nui_language=US_en\n";
+
+// The "preferences" array of a getPreferences response, keyed by each entry's "key"
+JsonObject PreferencesByKey(const string& response)
+{
+    JsonObject result;
+    result.FromString(response);
+    JsonObject preferences;
+    JsonArray::Iterator index = result["preferences"].Array().Elements();
+    while (index.Next()) {
+        JsonObject entry = index.Current().Object();
+        preferences[entry["key"].String().c_str()] = entry;
+    }
+    return preferences;
+}
 }
 
 class UserPreferencesTest : public ::testing::Test {
 protected:
     Core::ProxyType<Plugin::UserPreferences> plugin;
+    Core::ProxyType<Plugin::UserPreferencesImplementation> userPreferencesImpl;
     Core::JSONRPC::Handler& handler;
+    Core::ProxyType<WorkerPoolImplementation> workerPool;
     DECL_CORE_JSONRPC_CONX connection;
     NiceMock<ServiceMock> service;
     Core::JSONRPC::Message message;
     NiceMock<COMLinkMock> comLinkMock;
     string response;
     NiceMock<UserSettingMock>* p_userSettingsMock = nullptr;  
+    PluginHost::IPlugin::INotification* pluginSink = nullptr;
     ServiceMock  *p_serviceMock  = nullptr;
     //NiceMock<WrapsImplMock>* p_wrapsImplMock = nullptr;
     std::string presentationLanguage;
@@ -63,12 +88,36 @@ protected:
     UserPreferencesTest()
         : plugin(Core::ProxyType<Plugin::UserPreferences>::Create())
         , handler(*(plugin))
+        , workerPool(Core::ProxyType<WorkerPoolImplementation>::Create(
+              2, Core::Thread::DefaultStackSize(), 16))
         , INIT_CONX(1, 0)
     {
+        // Requests, notifications and the write-behind jobs run on the pool; the migration has its own thread
+        Core::IWorkerPool::Assign(&(*workerPool));
+        workerPool->Run();
+
         p_userSettingsMock = new NiceMock<UserSettingMock>;
         // p_wrapsImplMock = new NiceMock<WrapsImplMock>;
         // Wraps::setImpl(p_wrapsImplMock);
 
+        // The plugin instantiates its implementation through the COM link, as in the out-of-process mode
+        ON_CALL(service, COMLink())
+            .WillByDefault(::testing::Return(&comLinkMock));
+#ifdef USE_THUNDER_R4
+        ON_CALL(comLinkMock, Instantiate(::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault([this](const RPC::Object&, const uint32_t, uint32_t& connectionId) -> void* {
+#else
+        ON_CALL(comLinkMock, Instantiate(::testing::_, ::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .WillByDefault([this](const RPC::Object&, const uint32_t, uint32_t& connectionId, const string&, const string&) -> void* {
+#endif
+                connectionId = 0;
+                userPreferencesImpl = Core::ProxyType<Plugin::UserPreferencesImplementation>::Create();
+                Exchange::IUserPreferences* implementation = &(*userPreferencesImpl);
+                // Released by the plugin in Deinitialize
+                implementation->AddRef();
+                return implementation;
+            });
+
         EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
 		    .WillRepeatedly(testing::Return(p_userSettingsMock));
 
@@ -94,6 +143,12 @@ protected:
         ON_CALL(*p_userSettingsMock, Register(::testing::_))
             .WillByDefault(Return(Core::ERROR_NONE));
 
+        // Lets tests report UserSettings (de)activating, as Thunder does
+        ON_CALL(service, Register(::testing::An<PluginHost::IPlugin::INotification*>()))
+            .WillByDefault([this](PluginHost::IPlugin::INotification* sink) {
+                pluginSink = sink;
+            });
+
 
         // Initialize plugin with mock service
         plugin->Initialize(&service);
@@ -101,9 +156,14 @@ protected:
 
     virtual ~UserPreferencesTest() {
         plugin->Deinitialize(&service);
+        // Destroys the implementation while the service mock is still alive
+        userPreferencesImpl.Release();
         //Wraps::setImpl(nullptr);
         //delete p_wrapsImplMock;
         delete p_userSettingsMock;
+
+        Core::IWorkerPool::Assign(nullptr);
+        workerPool.Release();
     }
 };
 
@@ -111,6 +171,10 @@ TEST_F(UserPreferencesTest, registeredMethods)
 {
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getUILanguage")));
     EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setUILanguage")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("getPreferences")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("setPreferences")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("isContentAllowed")));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Exists(_T("selectTracks")));
 }
 
 TEST_F(UserPreferencesTest, paramsMissing)
@@ -134,3 +198,976 @@ TEST_F(UserPreferencesTest, setUILanguage)
     EXPECT_EQ(response, _T("{\"ui_language\":\"CA_fr\",\"success\":true}"));
 }
 
+TEST_F(UserPreferencesTest, setUILanguageNormalizesCase)
+{
+    // UserSettings already holds en-US, so no notification corrects what is cached
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"us_EN\"}"), response));
+    EXPECT_EQ(response, _T("{\"success\":true}"));
+    EXPECT_EQ(currentPresentationLanguage, _T("en-US"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+}
+
+TEST_F(UserPreferencesTest, setUILanguageRejectsInvalidCodes)
+{
+    EXPECT_CALL(*p_userSettingsMock, SetPresentationLanguage(::testing::_))
+        .Times(0);
+
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"12_!!\"}"), response));
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"XX_en\"}"), response));
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"US_xx\"}"), response));
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"US-en\"}"), response));
+}
+
+TEST_F(UserPreferencesTest, getUILanguageAcceptsExtendedPresentationForms)
+{
+    currentPresentationLanguage = "eng-GB";
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"GB_en\",\"success\":true}"));
+}
+
+TEST_F(UserPreferencesTest, getUILanguageRejectsScriptSubtagWithoutRegion)
+{
+    currentPresentationLanguage = "zh-Hans";
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+}
+
+TEST_F(UserPreferencesTest, getUILanguageServedFromCache)
+{
+    // The first request waits for the migration thread, which primes the cache
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+
+    EXPECT_CALL(*p_userSettingsMock, GetPresentationLanguage(::testing::_))
+        .Times(0);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+}
+
+TEST_F(UserPreferencesTest, concurrentCallersShareOneMigration)
+{
+    EXPECT_CALL(*p_userSettingsMock, GetMigrationState(::testing::_, ::testing::_))
+        .Times(1)
+        .WillOnce([](const Exchange::IUserSettingsInspector::SettingsKey, bool& requiresMigration) {
+            requiresMigration = false;
+            return Core::ERROR_NONE;
+        });
+
+    const int callers = 8;
+    std::vector<std::thread> threads;
+    std::vector<string> responses(callers);
+    std::vector<uint32_t> results(callers, Core::ERROR_GENERAL);
+    for (int i = 0; i < callers; i++) {
+        threads.emplace_back([this, i, &responses, &results]() {
+            results[i] = handler.Invoke(connection, _T("getUILanguage"), _T("{}"), responses[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < callers; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, results[i]);
+        EXPECT_EQ(responses[i], _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+    }
+}
+
+TEST_F(UserPreferencesTest, callersWaitingForMigrationAllReleased)
+{
+    // The migration only proceeds once every caller is on its way, so all of them wait for it
+    const int callers = 8;
+    std::atomic<int> started(0);
+    EXPECT_CALL(*p_userSettingsMock, GetMigrationState(::testing::_, ::testing::_))
+        .Times(1)
+        .WillOnce([&started](const Exchange::IUserSettingsInspector::SettingsKey, bool& requiresMigration) {
+            while (started < callers) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            requiresMigration = false;
+            return Core::ERROR_NONE;
+        });
+
+    std::vector<std::thread> threads;
+    std::vector<string> responses(callers);
+    std::vector<uint32_t> results(callers, Core::ERROR_GENERAL);
+    for (int i = 0; i < callers; i++) {
+        threads.emplace_back([this, i, &started, &responses, &results]() {
+            started++;
+            results[i] = handler.Invoke(connection, _T("getUILanguage"), _T("{}"), responses[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // A waiter the migration event doesn't release fails with "Timed out waiting for migration"
+    for (int i = 0; i < callers; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, results[i]);
+        EXPECT_EQ(responses[i], _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+    }
+}
+
+namespace {
+class InvokeJob : public Core::IDispatch {
+public:
+    InvokeJob(const InvokeJob&) = delete;
+    InvokeJob& operator=(const InvokeJob&) = delete;
+
+    explicit InvokeJob(const std::function<void()>& work)
+        : _work(work)
+    {
+    }
+    ~InvokeJob() override = default;
+
+    void Dispatch() override { _work(); }
+
+private:
+    std::function<void()> _work;
+};
+}
+
+TEST_F(UserPreferencesTest, callersOnWorkerPoolDontStarveMigration)
+{
+    // More callers than pool threads: all of them are served by the pool, as JSON-RPC requests are
+    const int callers = 8;
+    std::vector<string> responses(callers);
+    std::vector<uint32_t> results(callers, Core::ERROR_GENERAL);
+    std::atomic<int> finished(0);
+    for (int i = 0; i < callers; i++) {
+        Core::ProxyType<Core::IDispatch> job(Core::ProxyType<InvokeJob>::Create([this, i, &responses, &results, &finished]() {
+            results[i] = handler.Invoke(connection, _T("getUILanguage"), _T("{}"), responses[i]);
+            finished++;
+        }));
+        Core::IWorkerPool::Instance().Submit(job);
+    }
+    // Callers starving the migration would each fail after MIGRATION_WAIT_TIMEOUT_MS
+    while (finished < callers) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (int i = 0; i < callers; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, results[i]);
+        EXPECT_EQ(responses[i], _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+    }
+}
+
+TEST_F(UserPreferencesTest, migrationFinishesWithWorkerPoolSaturated)
+{
+    // Every pool thread is busy until the request below returns
+    const int poolThreads = 2;
+    std::atomic<int> busy(0);
+    std::atomic<bool> release(false);
+    for (int i = 0; i < poolThreads; i++) {
+        Core::ProxyType<Core::IDispatch> job(Core::ProxyType<InvokeJob>::Create([&busy, &release]() {
+            busy++;
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            busy--;
+        }));
+        Core::IWorkerPool::Instance().Submit(job);
+    }
+    while (busy < poolThreads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+
+    release = true;
+    while (busy > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_F(UserPreferencesTest, getPreferencesServedFromCache)
+{
+    EXPECT_CALL(*p_userSettingsMock, GetCaptions(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& enabled) {
+            enabled = true;
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetVoiceGuidanceRate(::testing::_))
+        .Times(1)
+        .WillOnce([](double& rate) {
+            rate = 2;
+            return Core::ERROR_NONE;
+        });
+
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPreferences"), _T("{\"keys\":[\"captions\",\"voiceGuidanceRate\"]}"), response));
+        JsonObject preferences = PreferencesByKey(response);
+        EXPECT_TRUE(preferences["captions"].Object()["enabled"].Boolean());
+        EXPECT_DOUBLE_EQ(2, preferences["voiceGuidanceRate"].Object()["number"].Double());
+        EXPECT_FALSE(preferences.HasLabel("highContrast"));
+    }
+}
+
+TEST_F(UserPreferencesTest, getPreferencesRejectsUnknownKeys)
+{
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("getPreferences"), _T("{\"keys\":[\"captions\",\"volume\"]}"), response));
+    EXPECT_NE(Core::ERROR_NONE, handler.Invoke(connection, _T("getPreferences"), _T("{\"keys\":\"captions\"}"), response));
+}
+
+TEST_F(UserPreferencesTest, setPreferencesAppliesBatch)
+{
+    EXPECT_CALL(*p_userSettingsMock, SetCaptions(true))
+        .Times(1)
+        .WillOnce(Return(Core::ERROR_NONE));
+    EXPECT_CALL(*p_userSettingsMock, SetPreferredCaptionsLanguages(_T("fra")))
+        .Times(1)
+        .WillOnce(Return(Core::ERROR_NONE));
+    EXPECT_CALL(*p_userSettingsMock, GetCaptions(::testing::_))
+        .Times(0);
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPreferences"), _T("{\"preferences\":[{\"key\":\"captions\",\"enabled\":true},{\"key\":\"preferredCaptionsLanguages\",\"text\":\"fra\"}]}"), response));
+    EXPECT_EQ(response, _T("{\"failed\":[],\"success\":true}"));
+
+    // Written through to the cache
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPreferences"), _T("{\"keys\":[\"captions\",\"preferredCaptionsLanguages\"]}"), response));
+    JsonObject preferences = PreferencesByKey(response);
+    EXPECT_TRUE(preferences["captions"].Object()["enabled"].Boolean());
+    EXPECT_EQ(_T("fra"), preferences["preferredCaptionsLanguages"].Object()["text"].String());
+}
+
+TEST_F(UserPreferencesTest, setPreferencesRejectsInvalidBatch)
+{
+    EXPECT_CALL(*p_userSettingsMock, SetCaptions(::testing::_))
+        .Times(0);
+    EXPECT_CALL(*p_userSettingsMock, SetVoiceGuidanceRate(::testing::_))
+        .Times(0);
+
+    EXPECT_NE(Core::ERROR_NONE, handler.Invoke(connection, _T("setPreferences"), _T("{}"), response));
+    // Nothing is applied when any entry is wrong
+    EXPECT_NE(Core::ERROR_NONE, handler.Invoke(connection, _T("setPreferences"), _T("{\"preferences\":[{\"key\":\"captions\",\"enabled\":true},{\"key\":\"voiceGuidanceRate\",\"number\":\"fast\"}]}"), response));
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setPreferences"), _T("{\"preferences\":[{\"key\":\"captions\",\"enabled\":true},{\"key\":\"volume\",\"number\":10}]}"), response));
+}
+
+TEST_F(UserPreferencesTest, setPreferencesPresentationLanguageLikeSetUILanguage)
+{
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+
+    // Validated before anything is applied
+    EXPECT_CALL(*p_userSettingsMock, SetCaptions(::testing::_))
+        .Times(0);
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setPreferences"), _T("{\"preferences\":[{\"key\":\"captions\",\"enabled\":true},{\"key\":\"presentationLanguage\",\"text\":\"xx-XX\"}]}"), response));
+    EXPECT_EQ(_T("en-US"), currentPresentationLanguage);
+
+    // Set in canonical form, and the cached UI language follows without waiting for the notification
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPreferences"), _T("{\"preferences\":[{\"key\":\"presentationLanguage\",\"text\":\"FR-ca\"}]}"), response));
+    EXPECT_EQ(response, _T("{\"failed\":[],\"success\":true}"));
+    EXPECT_EQ(_T("fr-CA"), currentPresentationLanguage);
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"CA_fr\",\"success\":true}"));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getPreferences"), _T("{\"keys\":[\"presentationLanguage\"]}"), response));
+    EXPECT_EQ(_T("fr-CA"), PreferencesByKey(response)["presentationLanguage"].Object()["text"].String());
+}
+
+TEST_F(UserPreferencesTest, setPreferencesReportsFailedKeys)
+{
+    EXPECT_CALL(*p_userSettingsMock, SetHighContrast(true))
+        .WillOnce(Return(Core::ERROR_NONE));
+    EXPECT_CALL(*p_userSettingsMock, SetVoiceGuidance(true))
+        .WillOnce(Return(Core::ERROR_GENERAL));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setPreferences"), _T("{\"preferences\":[{\"key\":\"highContrast\",\"enabled\":true},{\"key\":\"voiceGuidance\",\"enabled\":true}]}"), response));
+    EXPECT_EQ(response, _T("{\"failed\":[\"voiceGuidance\"],\"success\":false}"));
+}
+
+TEST_F(UserPreferencesTest, isContentAllowedEvaluatesBatch)
+{
+    // Read once to compile the rules, then kept current by the notifications
+    EXPECT_CALL(*p_userSettingsMock, GetPinControl(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& pinControl) {
+            pinControl = true;
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetViewingRestrictions(::testing::_))
+        .Times(1)
+        .WillOnce([](string& viewingRestrictions) {
+            viewingRestrictions = _T("{\"restrictions\":[{\"scheme\":\"US_TV\",\"restrict\":[\"TV-14\",\"TV-PG/V\"]}]}");
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetViewingRestrictionsWindow(::testing::_))
+        .Times(1)
+        .WillOnce([](string& window) {
+            window = _T("ALWAYS");
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetLiveWatershed(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& liveWatershed) {
+            liveWatershed = false;
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetPlaybackWatershed(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& playbackWatershed) {
+            playbackWatershed = false;
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetBlockNotRatedContent(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& blockNotRatedContent) {
+            blockNotRatedContent = true;
+            return Core::ERROR_NONE;
+        });
+
+    const string request = _T("{\"content\":["
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-14\",\"airingTime\":1767225600},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-G\"},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-PG\",\"descriptorMask\":2},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-PG\",\"descriptorMask\":10},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"\"},"
+        "{\"scheme\":\"MPAA\",\"rating\":\"R\"},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-14\"},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-Y\"},"
+        "{\"scheme\":\"US_TV\",\"rating\":\"TV-Y7\"}]}");
+    // Allowed: 1, 2, 5, 7 and 8
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("isContentAllowed"), request, response));
+        EXPECT_EQ(response, _T("{\"allowed\":\"a601\",\"success\":true}"));
+    }
+
+    EXPECT_NE(Core::ERROR_NONE, handler.Invoke(connection, _T("isContentAllowed"), _T("{\"content\":[\"TV-14\"]}"), response));
+}
+
+TEST_F(UserPreferencesTest, selectTracksRanksBatch)
+{
+    // Read once to build the index, then kept current by the notifications
+    EXPECT_CALL(*p_userSettingsMock, GetPreferredAudioLanguages(::testing::_))
+        .Times(1)
+        .WillOnce([](string& preferredLanguages) {
+            preferredLanguages = _T("fra,eng");
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetPreferredCaptionsLanguages(::testing::_))
+        .Times(1)
+        .WillOnce([](string& preferredLanguages) {
+            preferredLanguages = _T("eng");
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetPreferredClosedCaptionService(::testing::_))
+        .Times(1)
+        .WillOnce([](string& service) {
+            service = _T("CC3");
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetCaptions(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& enabled) {
+            enabled = true;
+            return Core::ERROR_NONE;
+        });
+    EXPECT_CALL(*p_userSettingsMock, GetAudioDescription(::testing::_))
+        .Times(1)
+        .WillOnce([](bool& enabled) {
+            enabled = false;
+            return Core::ERROR_NONE;
+        });
+
+    const string request = _T("{\"tracks\":["
+        "{\"type\":\"audio\",\"language\":\"eng\"},"
+        "{\"type\":\"audio\",\"language\":\"fre\",\"audioDescription\":true},"
+        "{\"type\":\"audio\",\"language\":\"fr-CA\"},"
+        "{\"type\":\"captions\",\"language\":\"eng\",\"service\":\"CC1\"},"
+        "{\"type\":\"captions\",\"language\":\"en\",\"service\":\"CC3\"}]}");
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("selectTracks"), request, response));
+        EXPECT_EQ(response, _T("{\"audio\":2,\"captions\":4,\"success\":true}"));
+    }
+
+    EXPECT_NE(Core::ERROR_NONE, handler.Invoke(connection, _T("selectTracks"), _T("{\"tracks\":[\"eng\"]}"), response));
+}
+
+TEST_F(UserPreferencesTest, notificationsHandledOnWorker)
+{
+    Exchange::IUserSettings::INotification* sink = nullptr;
+    EXPECT_CALL(*p_userSettingsMock, Register(::testing::_))
+        .WillOnce([&sink](Exchange::IUserSettings::INotification* notification) {
+            sink = notification;
+            return Core::ERROR_NONE;
+        });
+    // Registers the notification
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    ASSERT_NE(nullptr, sink);
+
+    // A live read fails, so getPreferences only succeeds once the notified value is cached
+    EXPECT_CALL(*p_userSettingsMock, GetCaptions(::testing::_))
+        .WillRepeatedly(Return(Core::ERROR_UNAVAILABLE));
+
+    // Superseded changes collapse, the cache ends up with the last one
+    sink->OnPresentationLanguageChanged(_T("de-DE"));
+    sink->OnCaptionsChanged(false);
+    sink->OnCaptionsChanged(true);
+
+    uint32_t status = Core::ERROR_GENERAL;
+    for (int i = 0; (i < 100) && (Core::ERROR_NONE != status); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        status = handler.Invoke(connection, _T("getPreferences"), _T("{\"keys\":[\"captions\",\"presentationLanguage\"]}"), response);
+    }
+    ASSERT_EQ(Core::ERROR_NONE, status);
+    JsonObject preferences = PreferencesByKey(response);
+    EXPECT_TRUE(preferences["captions"].Object()["enabled"].Boolean());
+    EXPECT_EQ(_T("de-DE"), preferences["presentationLanguage"].Object()["text"].String());
+
+    // Queued first, so it was handled by the time the captions were
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"DE_de\",\"success\":true}"));
+}
+
+TEST_F(UserPreferencesTest, noLookupsWhileUserSettingsDeactivated)
+{
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    ASSERT_NE(nullptr, pluginSink);
+    pluginSink->Deactivated(_T("org.rdk.UserSettings"), &service);
+
+    // Requests go straight to the queued value or the file
+    EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
+        .Times(0);
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"CA_fr\"}"), response));
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+        EXPECT_EQ(response, _T("{\"ui_language\":\"CA_fr\",\"success\":true}"));
+    }
+    EXPECT_EQ(_T("en-US"), currentPresentationLanguage);
+
+    // Only the activation looks it up again, and applies the queued value
+    EXPECT_CALL(service, QueryInterfaceByCallsign(::testing::_, ::testing::_))
+        .WillRepeatedly(Return(p_userSettingsMock));
+    pluginSink->Activated(_T("org.rdk.UserSettings"), &service);
+    for (int i = 0; (i < 100) && (currentPresentationLanguage != _T("fr-CA")); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(_T("fr-CA"), currentPresentationLanguage);
+}
+
+TEST_F(UserPreferencesTest, externalFileEditReachesUserSettings)
+{
+    // Migration writes the file, so later writes by the plugin itself are recognised
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+
+    // As a legacy script would: in place, without the plugin
+    std::ofstream file(userPrefFile, std::ios::trunc);
+    if (!file) {
+        GTEST_SKIP() << "Can't write " << userPrefFile;
+    }
+    file << "[General]\nui_language=DE_de\n";
+    file.close();
+
+    for (int i = 0; (i < 100) && (currentPresentationLanguage != _T("de-DE")); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(_T("de-DE"), currentPresentationLanguage);
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"DE_de\",\"success\":true}"));
+}
+
+TEST_F(UserPreferencesTest, externalFileReplaceReachesUserSettings)
+{
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(response, _T("{\"ui_language\":\"US_en\",\"success\":true}"));
+
+    // Written next to it and renamed over it, as editors do; the watch follows to the new file
+    const string temporary = userPrefFile + _T(".edit");
+    for (const TCHAR* language : { _T("DE_de"), _T("CA_fr") }) {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file) {
+            GTEST_SKIP() << "Can't write " << temporary;
+        }
+        file << "[General]\nui_language=" << language << "\n";
+        file.close();
+        ASSERT_EQ(0, ::rename(temporary.c_str(), userPrefFile.c_str()));
+
+        const string expected = (string(language) == _T("DE_de") ? _T("de-DE") : _T("fr-CA"));
+        for (int i = 0; (i < 100) && (currentPresentationLanguage != expected); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        EXPECT_EQ(expected, currentPresentationLanguage);
+        // Past the write-behind (persistdelay, 500 ms by default) of the value just applied, so it
+        // can't land on top of the next edit
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    }
+}
+
+TEST_F(UserPreferencesTest, comInterfaceWithoutJson)
+{
+    Exchange::IUserPreferences* userPreferences = plugin->QueryInterface<Exchange::IUserPreferences>();
+    ASSERT_NE(nullptr, userPreferences);
+
+    bool success = false;
+    EXPECT_EQ(Core::ERROR_NONE, userPreferences->SetUILanguage(_T("CA_fr"), success));
+    EXPECT_TRUE(success);
+    EXPECT_EQ(_T("fr-CA"), currentPresentationLanguage);
+
+    string uiLanguage;
+    success = false;
+    EXPECT_EQ(Core::ERROR_NONE, userPreferences->GetUILanguage(uiLanguage, success));
+    EXPECT_TRUE(success);
+    EXPECT_EQ(_T("CA_fr"), uiLanguage);
+
+    EXPECT_EQ(Core::ERROR_GENERAL, userPreferences->SetUILanguage(_T("12_!!"), success));
+    EXPECT_FALSE(success);
+
+    // Typed values both ways, nothing for the implementation to parse
+    EXPECT_CALL(*p_userSettingsMock, SetHighContrast(true))
+        .WillOnce(Return(Core::ERROR_NONE));
+    std::list<Exchange::IUserPreferences::Preference> batch;
+    batch.push_back({ _T("highContrast"), true, string(), 0 });
+    Exchange::IUserPreferences::IPreferenceIterator* preferences = Core::Service<RPC::IteratorType<Exchange::IUserPreferences::IPreferenceIterator>>::Create<Exchange::IUserPreferences::IPreferenceIterator>(batch);
+    RPC::IStringIterator* failed = nullptr;
+    EXPECT_EQ(Core::ERROR_NONE, userPreferences->SetPreferences(preferences, failed, success));
+    preferences->Release();
+    EXPECT_TRUE(success);
+    ASSERT_NE(nullptr, failed);
+    EXPECT_EQ(0u, failed->Count());
+    failed->Release();
+
+    RPC::IStringIterator* keys = Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(std::list<string>{ _T("highContrast") });
+    preferences = nullptr;
+    EXPECT_EQ(Core::ERROR_NONE, userPreferences->GetPreferences(keys, preferences, success));
+    keys->Release();
+    ASSERT_NE(nullptr, preferences);
+    Exchange::IUserPreferences::Preference preference;
+    ASSERT_TRUE(preferences->Next(preference));
+    EXPECT_EQ(_T("highContrast"), preference.key);
+    EXPECT_TRUE(preference.enabled);
+    EXPECT_FALSE(preferences->Next(preference));
+    preferences->Release();
+
+    userPreferences->Release();
+}
+
+TEST_F(UserPreferencesTest, getMetricsCountsRequests)
+{
+    if (Core::ERROR_NONE != handler.Exists(_T("getMetrics"))) {
+        GTEST_SKIP() << "Plugin built without PLUGIN_USERPREFERENCES_METRICS";
+    }
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getUILanguage"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_GENERAL, handler.Invoke(connection, _T("setUILanguage"), _T("{\"ui_language\":\"12_!!\"}"), response));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getMetrics"), _T("{}"), response));
+    JsonObject result;
+    result.FromString(response);
+    JsonObject metrics = result["metrics"].Object();
+    EXPECT_EQ(2, metrics["getUILanguage"].Object()["count"].Number());
+    EXPECT_EQ(0, metrics["getUILanguage"].Object()["errors"].Number());
+    EXPECT_EQ(1, metrics["setUILanguage"].Object()["count"].Number());
+    EXPECT_EQ(1, metrics["setUILanguage"].Object()["errors"].Number());
+    EXPECT_TRUE(metrics["getUILanguage"].Object().HasLabel("p99"));
+
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("resetMetrics"), _T("{}"), response));
+    EXPECT_EQ(Core::ERROR_NONE, handler.Invoke(connection, _T("getMetrics"), _T("{}"), response));
+    result.FromString(response);
+    metrics = result["metrics"].Object();
+    EXPECT_EQ(0, metrics["getUILanguage"].Object()["count"].Number());
+}
+
+TEST(StateSnapshotTest, versionedUpdates)
+{
+    Plugin::StateSnapshot state;
+    string uiLanguage;
+    Plugin::StateSnapshot::View initial = state.Get();
+    EXPECT_FALSE(initial.UILanguage(uiLanguage));
+    EXPECT_FALSE(initial.IsUserSettingsAvailable());
+    EXPECT_EQ(Plugin::StateSnapshot::MigrationState::PENDING, initial.Migration());
+
+    state.SetUILanguage(_T("US_en"));
+    state.SetUserSettingsAvailable(true);
+    Plugin::StateSnapshot::MigrationState expected = Plugin::StateSnapshot::MigrationState::DONE;
+    EXPECT_FALSE(state.ExchangeMigration(expected, Plugin::StateSnapshot::MigrationState::RUNNING));
+    EXPECT_EQ(Plugin::StateSnapshot::MigrationState::PENDING, expected);
+    EXPECT_TRUE(state.ExchangeMigration(expected, Plugin::StateSnapshot::MigrationState::RUNNING));
+
+    Plugin::StateSnapshot::View current = state.Get();
+    EXPECT_EQ(initial.Version() + 3, current.Version());
+    EXPECT_TRUE(current.UILanguage(uiLanguage));
+    EXPECT_EQ(_T("US_en"), uiLanguage);
+    EXPECT_TRUE(current.IsUserSettingsAvailable());
+    EXPECT_EQ(Plugin::StateSnapshot::MigrationState::RUNNING, current.Migration());
+
+    // A view is a copy
+    state.ClearUILanguage();
+    EXPECT_TRUE(current.UILanguage(uiLanguage));
+    EXPECT_FALSE(state.Get().UILanguage(uiLanguage));
+    EXPECT_TRUE(state.Get().IsUserSettingsAvailable());
+}
+
+TEST(StateSnapshotTest, readersNeverSeeTornState)
+{
+    Plugin::StateSnapshot state;
+    state.SetUILanguage(_T("US_en"));
+    std::atomic<bool> done(false);
+
+    std::thread writer([&state, &done]() {
+        for (int i = 0; i < 100000; i++) {
+            state.SetUILanguage((i % 2) == 0 ? _T("DE_de") : _T("US_en"));
+            state.SetUserSettingsAvailable((i % 3) == 0);
+        }
+        done = true;
+    });
+    std::vector<std::thread> readers;
+    std::atomic<int> torn(0);
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&state, &done, &torn]() {
+            string uiLanguage;
+            while (!done) {
+                if (!state.Get().UILanguage(uiLanguage) || ((uiLanguage != _T("DE_de")) && (uiLanguage != _T("US_en")))) {
+                    torn++;
+                }
+            }
+        });
+    }
+    writer.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0, torn.load());
+}
+
+TEST(SnapshotTest, readerSeesPublishedPreferences)
+{
+    const string path = _T("/tmp/user_preferences_l1.snapshot");
+    ::unlink(path.c_str());
+    EXPECT_FALSE(UserPreferencesSnapshot::Reader(path.c_str()).IsOpen());
+
+    Plugin::SnapshotPublisher publisher;
+    ASSERT_EQ(Core::ERROR_NONE, publisher.Open(path));
+    UserPreferencesSnapshot::Reader reader(path.c_str());
+    ASSERT_TRUE(reader.IsOpen());
+
+    UserPreferencesSnapshot::Data data;
+    ASSERT_TRUE(reader.Read(data));
+    EXPECT_EQ(0u, data.Valid);
+    const uint32_t initial = reader.Version();
+
+    publisher.SetUILanguage(_T("US_en"));
+    publisher.Set(Plugin::SettingsCache::PRESENTATION_LANGUAGE, JsonValue(_T("en-US")));
+    publisher.Set(Plugin::SettingsCache::CAPTIONS, JsonValue(true));
+    publisher.Set(Plugin::SettingsCache::VOICE_GUIDANCE_RATE, JsonValue(1.5));
+    publisher.Set(Plugin::SettingsCache::PIN_CONTROL, JsonValue(true));     // not in the snapshot
+
+    uint32_t version = 0;
+    ASSERT_TRUE(reader.Read(data, &version));
+    EXPECT_EQ(initial + 8, version);
+    EXPECT_STREQ("US_en", data.UILanguage);
+    EXPECT_STREQ("en-US", data.PresentationLanguage);
+    EXPECT_TRUE(data.IsOn(UserPreferencesSnapshot::CAPTIONS));
+    EXPECT_FALSE(data.Has(UserPreferencesSnapshot::HIGH_CONTRAST));
+    EXPECT_DOUBLE_EQ(1.5, data.VoiceGuidanceRate);
+
+    // UserSettings went away: only the UI language is kept
+    publisher.ClearSettings();
+    ASSERT_TRUE(reader.Read(data));
+    EXPECT_EQ(static_cast<uint32_t>(UserPreferencesSnapshot::UI_LANGUAGE), data.Valid);
+
+    // A new publisher reuses the file, so the mapping of the reader stays valid
+    publisher.Close();
+    Plugin::SnapshotPublisher restarted;
+    ASSERT_EQ(Core::ERROR_NONE, restarted.Open(path));
+    restarted.SetUILanguage(_T("DE_de"));
+    ASSERT_TRUE(reader.Read(data, &version));
+    EXPECT_STREQ("DE_de", data.UILanguage);
+    EXPECT_EQ(reader.Version(), version);
+
+    restarted.Close();
+    ::unlink(path.c_str());
+}
+
+TEST(SnapshotTest, readsAreConsistentDuringWrites)
+{
+    const string path = _T("/tmp/user_preferences_l1_load.snapshot");
+    ::unlink(path.c_str());
+    Plugin::SnapshotPublisher publisher;
+    ASSERT_EQ(Core::ERROR_NONE, publisher.Open(path));
+    UserPreferencesSnapshot::Reader reader(path.c_str());
+    ASSERT_TRUE(reader.IsOpen());
+    std::atomic<bool> done(false);
+
+    // Readers must only ever see one of the two languages, never a mix of their bytes
+    std::thread writer([&publisher, &done]() {
+        for (int i = 0; i < 20000; i++) {
+            const bool german = ((i % 2) == 0);
+            publisher.SetUILanguage(german ? _T("DE_de") : _T("US_en"));
+            publisher.Set(Plugin::SettingsCache::PRESENTATION_LANGUAGE, JsonValue(german ? _T("de-DE") : _T("en-US")));
+        }
+        done = true;
+    });
+    uint32_t torn = 0;
+    uint32_t version = 0;
+    UserPreferencesSnapshot::Data data;
+    while (!done) {
+        uint32_t current = 0;
+        if (reader.Read(data, &current)) {
+            EXPECT_EQ(0u, (current & 1));
+            EXPECT_GE(current, version);
+            version = current;
+            const string uiLanguage(data.UILanguage);
+            if ((uiLanguage != _T("DE_de")) && (uiLanguage != _T("US_en")) && data.Has(UserPreferencesSnapshot::UI_LANGUAGE)) {
+                torn++;
+            }
+        }
+    }
+    writer.join();
+    EXPECT_EQ(0u, torn);
+
+    publisher.Close();
+    ::unlink(path.c_str());
+}
+
+namespace {
+typedef Plugin::ViewingRestrictions::Content Content;
+const uint32_t D = Exchange::IUserPreferences::DESCRIPTOR_DIALOGUE;
+const uint32_t L = Exchange::IUserPreferences::DESCRIPTOR_LANGUAGE;
+const uint32_t S = Exchange::IUserPreferences::DESCRIPTOR_SEXUAL_CONTENT;
+const uint32_t V = Exchange::IUserPreferences::DESCRIPTOR_VIOLENCE;
+
+bool IsSet(const std::vector<uint8_t>& allowed, const size_t index)
+{
+    return ((allowed[index / 8] & (1u << (index % 8))) != 0);
+}
+
+void Restrict(Plugin::ViewingRestrictions& restrictions, const string& viewingRestrictions, const string& window, const bool watershed)
+{
+    restrictions.Update(Plugin::SettingsCache::PIN_CONTROL, JsonValue(true));
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS, JsonValue(viewingRestrictions));
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS_WINDOW, JsonValue(window));
+    restrictions.Update(Plugin::SettingsCache::LIVE_WATERSHED, JsonValue(watershed));
+    restrictions.Update(Plugin::SettingsCache::PLAYBACK_WATERSHED, JsonValue(false));
+    restrictions.Update(Plugin::SettingsCache::BLOCK_NOT_RATED_CONTENT, JsonValue(false));
+}
+
+class ViewingRestrictionsTest : public ::testing::Test {
+protected:
+    ViewingRestrictionsTest()
+        : _timezone(::getenv("TZ") != nullptr ? ::getenv("TZ") : "")
+        , _hadTimezone(::getenv("TZ") != nullptr)
+    {
+        // Airing times below are in UTC
+        ::setenv("TZ", "UTC", 1);
+        ::tzset();
+    }
+    ~ViewingRestrictionsTest() override
+    {
+        if (_hadTimezone) {
+            ::setenv("TZ", _timezone.c_str(), 1);
+        } else {
+            ::unsetenv("TZ");
+        }
+        ::tzset();
+    }
+
+private:
+    const string _timezone;
+    const bool _hadTimezone;
+};
+}
+
+TEST_F(ViewingRestrictionsTest, ratingsAndDescriptors)
+{
+    Plugin::ViewingRestrictions restrictions;
+    const Content content[] = {
+        { _T("US_TV"), _T("TV-14"), 0, 0 },
+        { _T("US_TV"), _T("TV-PG"), S, 0 },
+        { _T("US_TV"), _T("TV-PG"), D, 0 },
+        { _T("US_TV"), _T(""), 0, 0 },
+        { _T("MPAA"), _T("R"), 0, 0 }
+    };
+    std::vector<uint8_t> allowed;
+
+    // Nothing is restricted until pinControl is known to be on
+    restrictions.Evaluate(content, 5, 0, allowed);
+    ASSERT_EQ(1u, allowed.size());
+    EXPECT_EQ(0x1F, allowed[0]);
+    EXPECT_FALSE(restrictions.IsComplete());
+
+    Restrict(restrictions, _T("{\"restrictions\":[{\"scheme\":\"US_TV\",\"restrict\":[\"TV-14\",\"TV-PG/V/S\"]},{\"scheme\":\"MPAA\",\"restrict\":[]}]}"), _T("ALWAYS"), false);
+    EXPECT_TRUE(restrictions.IsComplete());
+    restrictions.Evaluate(content, 5, 0, allowed);
+    EXPECT_FALSE(IsSet(allowed, 0));
+    EXPECT_FALSE(IsSet(allowed, 1));
+    EXPECT_TRUE(IsSet(allowed, 2));
+    EXPECT_TRUE(IsSet(allowed, 3));
+    EXPECT_TRUE(IsSet(allowed, 4));
+
+    restrictions.Update(Plugin::SettingsCache::BLOCK_NOT_RATED_CONTENT, JsonValue(true));
+    restrictions.Evaluate(content, 5, 0, allowed);
+    EXPECT_FALSE(IsSet(allowed, 3));
+
+    // A descriptor without a ContentDescriptor bit can't be matched, so it blocks the rating outright
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS, JsonValue(_T("{\"restrictions\":[{\"scheme\":\"US_TV\",\"restrict\":[\"TV-PG/X\"]}]}")));
+    restrictions.Evaluate(content, 5, 0, allowed);
+    EXPECT_TRUE(IsSet(allowed, 0));
+    EXPECT_FALSE(IsSet(allowed, 1));
+    EXPECT_FALSE(IsSet(allowed, 2));
+
+    restrictions.Update(Plugin::SettingsCache::PIN_CONTROL, JsonValue(false));
+    restrictions.Evaluate(content, 5, 0, allowed);
+    EXPECT_EQ(0x1F, allowed[0]);
+
+    // UserSettings went away: the inputs must be read again
+    restrictions.Invalidate();
+    EXPECT_FALSE(restrictions.IsComplete());
+}
+
+TEST_F(ViewingRestrictionsTest, watershedWindow)
+{
+    Plugin::ViewingRestrictions restrictions;
+    const int64_t midnight = 1767225600;    // 2026-01-01 00:00 UTC
+    const Content content[] = {
+        { _T("US_TV"), _T("TV-14"), 0, midnight + (10 * 3600) },
+        { _T("US_TV"), _T("TV-14"), 0, midnight + (22 * 3600) },
+        { _T("US_TV"), _T("TV-14"), 0, 0 }
+    };
+    std::vector<uint8_t> allowed;
+
+    // Restricted from 06:00 to 21:00 for live content, always for playback
+    Restrict(restrictions, _T("{\"restrictions\":[{\"scheme\":\"US_TV\",\"restrict\":[\"TV-14\"]}]}"), _T("06:00-21:00"), true);
+    restrictions.Evaluate(content, 3, midnight + (22 * 3600), allowed);
+    EXPECT_FALSE(IsSet(allowed, 0));
+    EXPECT_TRUE(IsSet(allowed, 1));
+    EXPECT_FALSE(IsSet(allowed, 2));
+
+    // Windows may wrap midnight
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS_WINDOW, JsonValue(_T("21:00-06:00")));
+    restrictions.Evaluate(content, 3, midnight, allowed);
+    EXPECT_TRUE(IsSet(allowed, 0));
+    EXPECT_FALSE(IsSet(allowed, 1));
+
+    // A window that can't be parsed restricts at any time
+    restrictions.Update(Plugin::SettingsCache::VIEWING_RESTRICTIONS_WINDOW, JsonValue(_T("evenings")));
+    restrictions.Evaluate(content, 3, midnight, allowed);
+    EXPECT_FALSE(IsSet(allowed, 0));
+    EXPECT_FALSE(IsSet(allowed, 1));
+}
+
+TEST_F(ViewingRestrictionsTest, epgGridEvaluatedInOneCall)
+{
+    Plugin::ViewingRestrictions restrictions;
+    Restrict(restrictions, _T("{\"restrictions\":[{\"scheme\":\"US_TV\",\"restrict\":[\"TV-14\",\"TV-MA\",\"TV-PG/V/S\"]},{\"scheme\":\"MPAA\",\"restrict\":[\"R\",\"NC-17\"]}]}"), _T("06:00-21:00"), true);
+
+    // A week of 30 minute slots on 24 channels
+    const TCHAR* const ratings[] = { _T("TV-Y"), _T("TV-G"), _T("TV-PG"), _T("TV-14"), _T("TV-MA") };
+    const int64_t start = 1767225600;
+    std::vector<Content> grid;
+    for (uint32_t index = 0; index < (7 * 48 * 24); index++) {
+        grid.push_back({ _T("US_TV"), ratings[index % 5], (((index % 3) == 0 ? V : L) | D), start + ((index / 24) * 1800) });
+    }
+
+    // Timed for information only; the numbers to watch come from Tests/Benchmarks
+    std::vector<uint8_t> allowed;
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (int run = 0; run < 10; run++) {
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        restrictions.Evaluate(grid.data(), grid.size(), start, allowed);
+        best = std::min<int64_t>(best, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+    }
+    RecordProperty("entries", static_cast<int>(grid.size()));
+    RecordProperty("evaluate_us", static_cast<int>(best));
+
+    // Restricted: TV-14, TV-MA and TV-PG with V, airing from 06:00 to 21:00
+    ASSERT_EQ((grid.size() + 7) / 8, allowed.size());
+    uint32_t mismatches = 0;
+    for (uint32_t index = 0; index < grid.size(); index++) {
+        const uint32_t rating = (index % 5);
+        const uint32_t minute = ((((index / 24) * 1800) % 86400) / 60);
+        const bool restricted = ((rating == 3) || (rating == 4) || ((rating == 2) && ((index % 3) == 0)));
+        const bool expected = (!restricted || (minute < (6 * 60)) || (minute >= (21 * 60)));
+        if (IsSet(allowed, index) != expected) {
+            mismatches++;
+        }
+    }
+    EXPECT_EQ(0u, mismatches);
+}
+
+namespace {
+typedef Plugin::TrackPreferences::Track Track;
+const Exchange::IUserPreferences::TrackType AUDIO = Exchange::IUserPreferences::TRACK_AUDIO;
+const Exchange::IUserPreferences::TrackType CAPTIONS = Exchange::IUserPreferences::TRACK_CAPTIONS;
+
+void Prefer(Plugin::TrackPreferences& tracks, const string& audio, const string& captions, const string& service, const bool captionsEnabled, const bool audioDescription)
+{
+    tracks.Update(Plugin::SettingsCache::PREFERRED_AUDIO_LANGUAGES, JsonValue(audio));
+    tracks.Update(Plugin::SettingsCache::PREFERRED_CAPTIONS_LANGUAGES, JsonValue(captions));
+    tracks.Update(Plugin::SettingsCache::PREFERRED_CLOSED_CAPTION_SERVICE, JsonValue(service));
+    tracks.Update(Plugin::SettingsCache::CAPTIONS, JsonValue(captionsEnabled));
+    tracks.Update(Plugin::SettingsCache::AUDIO_DESCRIPTION, JsonValue(audioDescription));
+}
+}
+
+TEST(TrackPreferencesTest, languagesNormalised)
+{
+    Plugin::TrackPreferences tracks;
+    const Track candidates[] = {
+        { AUDIO, _T("spa"), _T(""), false },
+        { AUDIO, _T("en-US"), _T(""), false },
+        { AUDIO, _T("fre"), _T(""), false },
+        { CAPTIONS, _T("ENG"), _T(""), false }
+    };
+
+    // Until anything is known the first audio track wins and captions stay off
+    Plugin::TrackPreferences::Selection selection = tracks.Select(candidates, 4);
+    EXPECT_EQ(0, selection.Audio);
+    EXPECT_EQ(-1, selection.Captions);
+    EXPECT_FALSE(tracks.IsComplete());
+
+    // 2 and 3-letter codes, both ISO 639-2 forms, any case and spacing
+    Prefer(tracks, _T(" FR , eng,fra"), _T("en"), _T(""), true, false);
+    EXPECT_TRUE(tracks.IsComplete());
+    selection = tracks.Select(candidates, 4);
+    EXPECT_EQ(2, selection.Audio);
+    EXPECT_EQ(3, selection.Captions);
+
+    tracks.Update(Plugin::SettingsCache::PREFERRED_AUDIO_LANGUAGES, JsonValue(_T("eng")));
+    EXPECT_EQ(1, tracks.Select(candidates, 4).Audio);
+
+    // A track in no preferred language still beats no track
+    tracks.Update(Plugin::SettingsCache::PREFERRED_AUDIO_LANGUAGES, JsonValue(_T("deu")));
+    EXPECT_EQ(0, tracks.Select(candidates, 4).Audio);
+
+    tracks.Update(Plugin::SettingsCache::CAPTIONS, JsonValue(false));
+    EXPECT_EQ(-1, tracks.Select(candidates, 4).Captions);
+    EXPECT_EQ(-1, tracks.Select(candidates, 0).Audio);
+
+    // UserSettings went away: the inputs must be read again
+    tracks.Invalidate();
+    EXPECT_FALSE(tracks.IsComplete());
+}
+
+TEST(TrackPreferencesTest, secondaryCriteria)
+{
+    Plugin::TrackPreferences tracks;
+    const Track candidates[] = {
+        { AUDIO, _T("eng"), _T(""), false },
+        { AUDIO, _T("eng"), _T(""), true },
+        { AUDIO, _T("qaa"), _T(""), true },
+        { CAPTIONS, _T("eng"), _T("CC1"), false },
+        { CAPTIONS, _T("eng"), _T("CC3"), false },
+        { CAPTIONS, _T("qaa"), _T("CC3"), false }
+    };
+
+    // Language first, then the audioDescription setting and the caption service
+    Prefer(tracks, _T("eng,qaa"), _T("eng,qaa"), _T("CC3"), true, true);
+    Plugin::TrackPreferences::Selection selection = tracks.Select(candidates, 6);
+    EXPECT_EQ(1, selection.Audio);
+    EXPECT_EQ(4, selection.Captions);
+
+    tracks.Update(Plugin::SettingsCache::AUDIO_DESCRIPTION, JsonValue(false));
+    tracks.Update(Plugin::SettingsCache::PREFERRED_CLOSED_CAPTION_SERVICE, JsonValue(_T("")));
+    selection = tracks.Select(candidates, 6);
+    EXPECT_EQ(0, selection.Audio);
+    EXPECT_EQ(3, selection.Captions);
+
+    // ISO 639-2 codes without a 2-letter form rank as well
+    tracks.Update(Plugin::SettingsCache::PREFERRED_AUDIO_LANGUAGES, JsonValue(_T("qaa,eng")));
+    tracks.Update(Plugin::SettingsCache::PREFERRED_CAPTIONS_LANGUAGES, JsonValue(_T("QAA")));
+    selection = tracks.Select(candidates, 6);
+    EXPECT_EQ(2, selection.Audio);
+    EXPECT_EQ(5, selection.Captions);
+}
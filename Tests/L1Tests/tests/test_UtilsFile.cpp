@@ -18,6 +18,10 @@
  */
 
 #include <gtest/gtest.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <vector>
 
 #include "Module.h"
 
@@ -62,3 +66,189 @@ TEST(UtilsFileTest, createFolder_createFile_moveFile_verifyFile)
     EXPECT_EQ(sizeof(bytes), file2.Read(buffer, 2 * sizeof(bytes)));
     EXPECT_EQ(0, memcmp(buffer, bytes, sizeof(bytes)));
 }
+
+TEST(UtilsFileTest, moveFile_existingDestination_fails)
+{
+    Core::Directory dir(_T("/tmp/UtilsFileTest"));
+    ASSERT_TRUE(dir.CreatePath());
+
+    Core::File from(string(_T("/tmp/UtilsFileTest/from")));
+    Core::File to(string(_T("/tmp/UtilsFileTest/to")));
+    from.Destroy();
+    to.Destroy();
+    ASSERT_TRUE(from.Create());
+    EXPECT_EQ(sizeof(bytes), from.Write(bytes, sizeof(bytes)));
+    from.Close();
+    ASSERT_TRUE(to.Create());
+    to.Close();
+
+    EXPECT_FALSE(Utils::MoveFile(from.Name(), to.Name()));
+    from.LoadFileInfo();
+    to.LoadFileInfo();
+    EXPECT_TRUE(from.Exists());
+    EXPECT_EQ(sizeof(bytes), from.Size());
+    EXPECT_EQ(0, to.Size());
+}
+
+TEST(UtilsFileTest, renameNoReplace_keepsDestinationCreatedMeanwhile)
+{
+    // What MoveFile runs into when the destination shows up after its Exists() check
+    Core::Directory dir(_T("/tmp/UtilsFileTest"));
+    ASSERT_TRUE(dir.CreatePath());
+
+    Core::File from(string(_T("/tmp/UtilsFileTest/from")));
+    Core::File to(string(_T("/tmp/UtilsFileTest/to")));
+    from.Destroy();
+    to.Destroy();
+    ASSERT_TRUE(from.Create());
+    EXPECT_EQ(sizeof(bytes), from.Write(bytes, sizeof(bytes)));
+    from.Close();
+    ASSERT_TRUE(to.Create());
+    to.Close();
+
+    EXPECT_FALSE(Utils::Internal::RenameNoReplace(from.Name().c_str(), to.Name().c_str()));
+    EXPECT_EQ(EEXIST, errno);
+    from.LoadFileInfo();
+    to.LoadFileInfo();
+    EXPECT_EQ(sizeof(bytes), from.Size());
+    EXPECT_EQ(0, to.Size());
+
+    to.Destroy();
+    EXPECT_TRUE(Utils::Internal::RenameNoReplace(from.Name().c_str(), to.Name().c_str()));
+    from.LoadFileInfo();
+    to.LoadFileInfo();
+    EXPECT_FALSE(from.Exists());
+    EXPECT_EQ(sizeof(bytes), to.Size());
+    to.Destroy();
+}
+
+namespace {
+// More than one page, not a multiple of it; the throughput on multi-MB files is in Tests/Benchmarks
+const size_t MOVE_TEST_BYTES = (64 * 1024) + 7;
+
+bool CreateTestFile(const string& name, std::vector<uint8_t>& content)
+{
+    content.resize(MOVE_TEST_BYTES);
+    for (size_t index = 0; index < content.size(); index++) {
+        content[index] = static_cast<uint8_t>((index * 131) ^ (index >> 12));
+    }
+    std::ofstream file(name, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    return file.good();
+}
+
+bool HasContent(const string& name, const std::vector<uint8_t>& content)
+{
+    std::ifstream file(name, std::ios::binary);
+    std::vector<uint8_t> read((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return (read == content);
+}
+}
+
+TEST(UtilsFileTest, moveFile_acrossFileSystems)
+{
+    // rename(2) can't be used here, so the file is copied in the kernel
+    const string from(_T("/tmp/UtilsFileTest/across"));
+    const string to(_T("/dev/shm/UtilsFileTest/across.1"));
+    struct stat source, destination;
+    ASSERT_TRUE(Core::Directory(_T("/tmp/UtilsFileTest")).CreatePath());
+    if ((::stat("/tmp/UtilsFileTest", &source) != 0) || (::stat("/dev/shm", &destination) != 0) || (source.st_dev == destination.st_dev)) {
+        GTEST_SKIP() << "/tmp and /dev/shm are not on different file systems";
+    }
+    ::unlink(to.c_str());
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(CreateTestFile(from, content));
+
+    EXPECT_TRUE(Utils::MoveFile(from, to));
+    EXPECT_TRUE(HasContent(to, content));
+    EXPECT_FALSE(Core::File(from).Exists());
+    ::unlink(to.c_str());
+    ::rmdir("/dev/shm/UtilsFileTest");
+}
+
+TEST(UtilsFileTest, kernelCopy_copiesWholeFile)
+{
+    // The copy MoveFile falls back to, on one file system so it runs everywhere
+    const string from(_T("/tmp/UtilsFileTest/copy"));
+    const string to(_T("/tmp/UtilsFileTest/copy.1"));
+    ASSERT_TRUE(Core::Directory(_T("/tmp/UtilsFileTest")).CreatePath());
+    ::unlink(to.c_str());
+    std::vector<uint8_t> content;
+    ASSERT_TRUE(CreateTestFile(from, content));
+
+    const int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(in, 0);
+    const int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    EXPECT_GE(out, 0);
+    if (out >= 0) {
+        EXPECT_EQ(Utils::Internal::CopyResult::DONE, Utils::Internal::KernelCopy(in, out));
+        ::close(out);
+        EXPECT_TRUE(HasContent(to, content));
+    }
+    ::close(in);
+    ::unlink(from.c_str());
+    ::unlink(to.c_str());
+}
+
+TEST(UtilsFileTest, getLastLine_separatorsAndEmptyLines)
+{
+    string line = _T("unchanged");
+    EXPECT_FALSE(Utils::getLastLine(_T(""), line));
+    EXPECT_FALSE(Utils::getLastLine(_T("\r\n\n\r"), line));
+    EXPECT_EQ(_T("unchanged"), line);
+
+    EXPECT_TRUE(Utils::getLastLine(_T("single"), line));
+    EXPECT_EQ(_T("single"), line);
+    EXPECT_TRUE(Utils::getLastLine(_T("first\nsecond\n\n"), line));
+    EXPECT_EQ(_T("second"), line);
+    EXPECT_TRUE(Utils::getLastLine(_T("first\r\nsecond\r\n"), line));
+    EXPECT_EQ(_T("second"), line);
+    // Progress output rewrites the line with '\r'
+    EXPECT_TRUE(Utils::getLastLine(_T("10%\r50%\r100%\r"), line));
+    EXPECT_EQ(_T("100%"), line);
+}
+
+TEST(UtilsFileTest, getLastLineOfFile)
+{
+    const string name(_T("/tmp/UtilsFileTest/output"));
+    ASSERT_TRUE(Core::Directory(_T("/tmp/UtilsFileTest")).CreatePath());
+    string line;
+
+    {
+        std::ofstream file(name, std::ios::trunc);
+        file << "first\nlast\n";
+    }
+    EXPECT_TRUE(Utils::getLastLineOfFile(name, line));
+    EXPECT_EQ(_T("last"), line);
+
+    {
+        std::ofstream file(name, std::ios::trunc);
+    }
+    EXPECT_FALSE(Utils::getLastLineOfFile(name, line));
+    ::unlink(name.c_str());
+    EXPECT_FALSE(Utils::getLastLineOfFile(name, line));
+}
+
+TEST(UtilsFileTest, getLastLine_longOutput)
+{
+    // Many short lines, as command output; the timings on multi-MB output are in Tests/Benchmarks
+    string output;
+    for (uint32_t index = 0; index < 1000; index++) {
+        output += _T("line ") + std::to_string(index) + _T(" of the command output\r\n");
+    }
+    output += _T("last line\n");
+    string line;
+    EXPECT_TRUE(Utils::getLastLine(output, line));
+    EXPECT_EQ(_T("last line"), line);
+
+    const string name(_T("/tmp/UtilsFileTest/output"));
+    ASSERT_TRUE(Core::Directory(_T("/tmp/UtilsFileTest")).CreatePath());
+    {
+        std::ofstream file(name, std::ios::binary | std::ios::trunc);
+        file << output;
+    }
+    line.clear();
+    EXPECT_TRUE(Utils::getLastLineOfFile(name, line));
+    EXPECT_EQ(_T("last line"), line);
+    ::unlink(name.c_str());
+}
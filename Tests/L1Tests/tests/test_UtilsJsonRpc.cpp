@@ -0,0 +1,150 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2026 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Module.h"
+
+#include "UtilsJsonRpc.h"
+
+using namespace WPEFramework;
+using ::Utils::JsonRpc::GetParam;
+using ::Utils::JsonRpc::ParamStatus;
+
+namespace {
+JsonObject Parameters()
+{
+    JsonObject parameters;
+    parameters["number"] = 42;
+    parameters["negative"] = -1;
+    parameters["numberText"] = _T("17");
+    parameters["partialText"] = _T("12abc");
+    parameters["float"] = 1.5;
+    parameters["floatText"] = _T("2.25");
+    parameters["boolean"] = true;
+    parameters["booleanText"] = _T("0");
+    parameters["text"] = _T("hello");
+    return parameters;
+}
+
+// Expands the shims the way a handler does, with "parameters" and "response" in scope
+uint32_t NumberHandler(const JsonObject& parameters, JsonObject& response)
+{
+    returnIfNumberParamNotFound(parameters, "number");
+    int number = -1;
+    getNumberParameter("number", number);
+    returnResponse(number == 42);
+}
+}
+
+TEST(UtilsJsonRpcTest, integers)
+{
+    const JsonObject parameters = Parameters();
+    int number = 0;
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "number", number));
+    EXPECT_EQ(42, number);
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "numberText", number));
+    EXPECT_EQ(17, number);
+
+    // param is only written on success
+    EXPECT_EQ(ParamStatus::WRONG_TYPE, GetParam(parameters, "partialText", number));
+    EXPECT_EQ(ParamStatus::WRONG_TYPE, GetParam(parameters, "text", number));
+    EXPECT_EQ(ParamStatus::NOT_FOUND, GetParam(parameters, "missing", number));
+    EXPECT_EQ(17, number);
+
+    uint32_t unsignedNumber = 5;
+    EXPECT_EQ(ParamStatus::OUT_OF_RANGE, GetParam(parameters, "negative", unsignedNumber));
+    EXPECT_EQ(5u, unsignedNumber);
+    int8_t small = 0;
+    JsonObject large;
+    large["value"] = 300;
+    EXPECT_EQ(ParamStatus::OUT_OF_RANGE, GetParam(large, "value", small));
+}
+
+TEST(UtilsJsonRpcTest, integersFromFloatsAreTruncated)
+{
+    const JsonObject parameters = Parameters();
+    int number = 0;
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "float", number));
+    EXPECT_EQ(1, number);
+
+    JsonObject floats;
+    floats["negative"] = -2.7;
+    floats["large"] = 300.5;
+    EXPECT_EQ(ParamStatus::OK, GetParam(floats, "negative", number));
+    EXPECT_EQ(-2, number);
+    int8_t small = 0;
+    EXPECT_EQ(ParamStatus::OUT_OF_RANGE, GetParam(floats, "large", small));
+    uint32_t unsignedNumber = 5;
+    EXPECT_EQ(ParamStatus::OUT_OF_RANGE, GetParam(floats, "negative", unsignedNumber));
+    EXPECT_EQ(5u, unsignedNumber);
+}
+
+TEST(UtilsJsonRpcTest, floatsBooleansStrings)
+{
+    const JsonObject parameters = Parameters();
+    double rate = 0;
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "float", rate));
+    EXPECT_DOUBLE_EQ(1.5, rate);
+    float floatRate = 0;
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "floatText", floatRate));
+    EXPECT_FLOAT_EQ(2.25f, floatRate);
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "number", rate));
+    EXPECT_DOUBLE_EQ(42, rate);
+
+    bool flag = false;
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "boolean", flag));
+    EXPECT_TRUE(flag);
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "booleanText", flag));
+    EXPECT_FALSE(flag);
+    EXPECT_EQ(ParamStatus::WRONG_TYPE, GetParam(parameters, "text", flag));
+
+    string text;
+    EXPECT_EQ(ParamStatus::OK, GetParam(parameters, "text", text));
+    EXPECT_EQ(_T("hello"), text);
+    EXPECT_EQ(ParamStatus::WRONG_TYPE, GetParam(parameters, "number", text));
+
+    EXPECT_EQ(ParamStatus::NOT_FOUND, GetParam(parameters, "missing", text, string(_T("fallback"))));
+    EXPECT_EQ(_T("fallback"), text);
+}
+
+TEST(UtilsJsonRpcTest, macroShims)
+{
+    const JsonObject parameters = Parameters();
+
+    int number = 9;
+    getNumberParameter("partialText", number);
+    EXPECT_EQ(0, number);
+    getDefaultNumberParameter("missing", number, 3);
+    EXPECT_EQ(3, number);
+    float rate = 0;
+    getFloatParameter("float", rate);
+    EXPECT_FLOAT_EQ(1.5f, rate);
+    bool flag = true;
+    getBoolParameter("text", flag);
+    EXPECT_FALSE(flag);
+    string text;
+    getDefaultStringParameter("number", text, "fallback");
+    EXPECT_EQ(_T("fallback"), text);
+
+    JsonObject response;
+    EXPECT_EQ(Core::ERROR_NONE, NumberHandler(parameters, response));
+    EXPECT_EQ(Core::ERROR_GENERAL, NumberHandler(JsonObject(), response));
+    EXPECT_FALSE(response["success"].Boolean());
+}
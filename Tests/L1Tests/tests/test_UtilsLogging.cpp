@@ -0,0 +1,139 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2026 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Module.h"
+
+#include "UtilsLogging.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+int evaluations = 0;
+
+int Evaluate()
+{
+    return ++evaluations;
+}
+
+class UtilsLoggingTest : public ::testing::Test {
+protected:
+    UtilsLoggingTest()
+        : _level(::Utils::Logging::Level())
+        , _synchronous(::Utils::Logging::Synchronous())
+    {
+    }
+    ~UtilsLoggingTest() override
+    {
+        ::Utils::Logging::Level(_level);
+        ::Utils::Logging::Synchronous(_synchronous);
+    }
+
+private:
+    const int _level;
+    const bool _synchronous;
+};
+}
+
+TEST_F(UtilsLoggingTest, gatedLinesDoNotEvaluateArguments)
+{
+    ::Utils::Logging::Level(LOG_LEVEL_WARN);
+    evaluations = 0;
+
+    LOGINFO("value %d", Evaluate());
+    EXPECT_EQ(0, evaluations);
+
+    LOGWARN("value %d", Evaluate());
+    EXPECT_EQ(1, evaluations);
+}
+
+TEST_F(UtilsLoggingTest, levelGating)
+{
+    ::Utils::Logging::Level(LOG_LEVEL_ERROR);
+    EXPECT_TRUE(::Utils::Logging::Enabled(LOG_LEVEL_ERROR));
+    EXPECT_FALSE(::Utils::Logging::Enabled(LOG_LEVEL_WARN));
+    EXPECT_FALSE(::Utils::Logging::Enabled(LOG_LEVEL_INFO));
+
+    ::Utils::Logging::Level(LOG_LEVEL_INFO);
+    EXPECT_TRUE(::Utils::Logging::Enabled(LOG_LEVEL_WARN));
+    EXPECT_TRUE(::Utils::Logging::Enabled(LOG_LEVEL_INFO));
+}
+
+TEST_F(UtilsLoggingTest, threadIdIsPerThread)
+{
+    const pid_t main = ::Utils::Logging::ThreadId();
+    EXPECT_EQ(main, ::Utils::Logging::ThreadId());
+
+    pid_t other = main;
+    std::thread thread([&other]() { other = ::Utils::Logging::ThreadId(); });
+    thread.join();
+    EXPECT_NE(main, other);
+}
+
+TEST_F(UtilsLoggingTest, concurrentWritersOverflowWithoutBlocking)
+{
+    ::Utils::Logging::Level(LOG_LEVEL_INFO);
+
+    // More lines than the ring holds: the excess is dropped, nobody waits for stderr
+    std::vector<std::thread> writers;
+    for (int writer = 0; writer < 4; writer++) {
+        writers.emplace_back([writer]() {
+            for (uint32_t line = 0; line < ::Utils::Logging::Sink::SLOTS; line++) {
+                LOGINFO("writer %d line %u", writer, line);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    EXPECT_EQ(::Utils::Logging::Sink::ALIVE, ::Utils::Logging::Sink::State().load());
+}
+
+TEST_F(UtilsLoggingTest, errorFlushesQueuedLinesFirst)
+{
+    ::Utils::Logging::Level(LOG_LEVEL_INFO);
+    ::Utils::Logging::Synchronous(false);
+
+    testing::internal::CaptureStderr();
+    LOGINFO("queued before error");
+    LOGERR("the error");
+    const std::string output = testing::internal::GetCapturedStderr();
+
+    const size_t queued = output.find("queued before error");
+    const size_t error = output.find("the error");
+    ASSERT_NE(std::string::npos, queued);
+    ASSERT_NE(std::string::npos, error);
+    EXPECT_LT(queued, error);
+}
+
+TEST_F(UtilsLoggingTest, synchronousWritesOnCallersThread)
+{
+    ::Utils::Logging::Level(LOG_LEVEL_INFO);
+    ::Utils::Logging::Synchronous(true);
+    EXPECT_TRUE(::Utils::Logging::Synchronous());
+
+    testing::internal::CaptureStderr();
+    LOGINFO("written now");
+    const std::string output = testing::internal::GetCapturedStderr();
+
+    EXPECT_NE(std::string::npos, output.find("written now"));
+}
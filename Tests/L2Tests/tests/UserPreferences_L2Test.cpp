@@ -23,7 +23,12 @@
 #include "L2TestsMock.h"
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
+#include <thread>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <vector>
 #include <interfaces/IUserSettings.h>
 
 #define JSON_TIMEOUT   (1000)
@@ -33,6 +38,13 @@
 #define USERPREFERENCE_CALLSIGN  _T("org.rdk.UserPreferences")
 #define USERSETTINGL2TEST_CALLSIGN _T("L2tests.1")
 
+#define USERPREFERENCES_FILE  "/opt/user_preferences.conf"
+
+#define STRESS_CLIENTS          8      // JSON-RPC client threads
+#define STRESS_REQUESTS         200    // Requests per client thread, one in four a setUILanguage
+#define STRESS_CHANGES          100    // setPresentationLanguage calls made on UserSettings meanwhile
+#define STRESS_SETTLE_MS        2000   // Longer than the write-behind and event quiet periods
+
 #define TEST_LOG(x, ...) fprintf(stderr, "\033[1;32m[%s:%d](%s)<PID:%d><TID:%d>" x "\n\033[0m", __FILE__, __LINE__, __FUNCTION__, getpid(), gettid(), ##__VA_ARGS__); fflush(stderr);
 
 
@@ -55,6 +67,7 @@ typedef enum : uint32_t {
     UserSettings_onPlaybackWatershedChanged = 0x0000000c,
     UserSettings_onBlockNotRatedContentChanged = 0x0000000d,
     UserSettings_onPinOnPurchaseChanged = 0x0000000e,
+    UserPreferences_onUILanguageChanged = 0x00000010,
     UserSettings_StateInvalid = 0x00000000
 }UserSettingsL2test_async_events_t;
 
@@ -78,6 +91,7 @@ class AsyncHandlerMock
         MOCK_METHOD(void, onPlaybackWatershedChanged, (const bool playbackWatershed));
         MOCK_METHOD(void, onBlockNotRatedContentChanged, (const bool blockNotRatedContent));
         MOCK_METHOD(void, onPinOnPurchaseChanged, (const bool pinOnPurchase));
+        MOCK_METHOD(void, onUILanguageChanged, (const string uiLanguage));
 
 };
 
@@ -90,6 +104,7 @@ public:
 
     // Mock methods for UserPreferences plugin
     void onPresentationLanguageChanged(const string presentationLanguage);
+    void onUILanguageChanged(const string uiLanguage);
     uint32_t WaitForRequestStatus(uint32_t timeout_ms, UserSettingsL2test_async_events_t expected_status);
 
     private:
@@ -158,6 +173,16 @@ void UserpreferencesTest::onPresentationLanguageChanged(const string presentatio
     m_condition_variable.notify_one();
 }
 
+void UserpreferencesTest::onUILanguageChanged(const string uiLanguage) {
+    TEST_LOG("onUILanguageChanged event triggered ***\n");
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    TEST_LOG("onUILanguageChanged received: %s\n", uiLanguage.c_str());
+
+    m_event_signalled |= UserPreferences_onUILanguageChanged;
+    m_condition_variable.notify_one();
+}
+
 uint32_t UserpreferencesTest::WaitForRequestStatus(uint32_t timeout_ms, UserSettingsL2test_async_events_t expected_status) {
     std::unique_lock<std::mutex> lock(m_mutex);
     auto now = std::chrono::system_clock::now();
@@ -247,4 +272,173 @@ TEST_F(UserpreferencesTest, UserPreferencesGetSetLanguage) {
     usersettings_jsonrpc.Unsubscribe(JSON_TIMEOUT, _T("onPresentationLanguageChanged"));
 }
 
-    
\ No newline at end of file
+    
+TEST_F(UserpreferencesTest, UserPreferencesUILanguageChangedEventCoalesced) {
+    JSONRPC::LinkType<Core::JSON::IElement> jsonrpc(USERPREFERENCE_CALLSIGN, USERSETTINGL2TEST_CALLSIGN);
+    StrictMock<AsyncHandlerMock> async_handler;
+    uint32_t status = Core::ERROR_GENERAL;
+    JsonObject params, result;
+    uint32_t signalled = UserSettings_StateInvalid;
+
+    status = jsonrpc.Subscribe<JsonObject>(JSON_TIMEOUT,
+                                           _T("onUILanguageChanged"),
+                                           [&async_handler](const JsonObject& parameters) {
+                                           string uiLanguage = parameters["ui_language"].String();
+                                           async_handler.onUILanguageChanged(uiLanguage);
+    });
+    EXPECT_EQ(Core::ERROR_NONE, status);
+
+    // A burst of changes is reported once, with the final value
+    EXPECT_CALL(async_handler, onUILanguageChanged(MatchRequestStatusString(string("DE_de"))))
+        .WillOnce(Invoke(this, &UserpreferencesTest::onUILanguageChanged));
+
+    const string burst[] = { "fr-CA", "es-MX", "de-DE" };
+    for (const string& language : burst) {
+        params["presentationLanguage"] = language;
+        status = InvokeServiceMethod("org.rdk.UserSettings", "setPresentationLanguage", params, result);
+        EXPECT_EQ(Core::ERROR_NONE, status);
+    }
+
+    signalled = WaitForRequestStatus(JSON_TIMEOUT, UserPreferences_onUILanguageChanged);
+    EXPECT_TRUE(signalled & UserPreferences_onUILanguageChanged);
+
+    // Give a stray second event the time to show up; StrictMock fails the test if it does
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    jsonrpc.Unsubscribe(JSON_TIMEOUT, _T("onUILanguageChanged"));
+}
+
+namespace {
+    struct LanguagePair {
+        const char* UILanguage;
+        const char* PresentationLanguage;
+    };
+    const LanguagePair StressLanguages[] = {
+        { "US_en", "en-US" },
+        { "CA_en", "en-CA" },
+        { "CA_fr", "fr-CA" },
+        { "DE_de", "de-DE" },
+        { "GB_en", "en-GB" }
+    };
+    const size_t StressLanguageCount = sizeof(StressLanguages) / sizeof(StressLanguages[0]);
+
+    bool IsStressUILanguage(const string& uiLanguage)
+    {
+        for (const LanguagePair& pair : StressLanguages) {
+            if (uiLanguage == pair.UILanguage) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    string ReadFileUILanguage()
+    {
+        std::ifstream file(USERPREFERENCES_FILE);
+        string line;
+        while (std::getline(file, line)) {
+            if (line.compare(0, 12, "ui_language=") == 0) {
+                return line.substr(12);
+            }
+        }
+        return string();
+    }
+
+    uint64_t Percentile(const std::vector<uint64_t>& sorted, const uint8_t percent)
+    {
+        return (sorted.empty() ? 0 : sorted[((sorted.size() - 1) * percent) / 100]);
+    }
+}
+
+/* Boot-time workload: several clients get and set the UI language over JSON-RPC while the
+* presentation language is changed on UserSettings directly. Every request must succeed, and once
+* things settle UserSettings, getUILanguage and the legacy file must agree. Build the plugins with
+* -DUSERPREFERENCES_TSAN=ON to have ThreadSanitizer check the same run. */
+TEST_F(UserpreferencesTest, UserPreferencesConcurrentLoad) {
+    std::vector<std::vector<uint64_t>> latencies(STRESS_CLIENTS);
+    std::atomic<uint32_t> failures(0);
+    std::atomic<uint32_t> unexpected(0);
+    std::atomic<uint32_t> changeFailures(0);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> clients;
+    for (uint32_t client = 0; client < STRESS_CLIENTS; client++) {
+        clients.emplace_back([client, &latencies, &failures, &unexpected]() {
+            JSONRPC::LinkType<Core::JSON::IElement> link(USERPREFERENCE_CALLSIGN, USERSETTINGL2TEST_CALLSIGN);
+            latencies[client].reserve(STRESS_REQUESTS);
+            for (uint32_t request = 0; request < STRESS_REQUESTS; request++) {
+                const bool set = ((request % 4) == 3);
+                JsonObject params, result;
+                if (set) {
+                    params["ui_language"] = StressLanguages[(client + request) % StressLanguageCount].UILanguage;
+                }
+                const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+                const uint32_t status = link.Invoke<JsonObject, JsonObject>(JSON_TIMEOUT, (set ? _T("setUILanguage") : _T("getUILanguage")), params, result);
+                latencies[client].push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count());
+
+                if ((Core::ERROR_NONE != status) || !result["success"].Boolean()) {
+                    failures++;
+                } else if (!set && !IsStressUILanguage(result["ui_language"].String())) {
+                    unexpected++;
+                }
+            }
+        });
+    }
+
+    std::thread userSettings([&changeFailures]() {
+        JSONRPC::LinkType<Core::JSON::IElement> link(USERSETTING_CALLSIGN, USERSETTINGL2TEST_CALLSIGN);
+        for (uint32_t change = 0; change < STRESS_CHANGES; change++) {
+            JsonObject params, result;
+            params["presentationLanguage"] = StressLanguages[change % StressLanguageCount].PresentationLanguage;
+            if (Core::ERROR_NONE != link.Invoke<JsonObject, JsonObject>(JSON_TIMEOUT, _T("setPresentationLanguage"), params, result)) {
+                changeFailures++;
+            }
+        }
+    });
+
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    userSettings.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::vector<uint64_t> all;
+    for (const std::vector<uint64_t>& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    TEST_LOG("%zu requests from %d clients in %.2f s: %.0f requests/s, latency us p50 %llu p95 %llu p99 %llu max %llu",
+        all.size(), STRESS_CLIENTS, seconds, (all.size() / seconds),
+        static_cast<unsigned long long>(Percentile(all, 50)), static_cast<unsigned long long>(Percentile(all, 95)),
+        static_cast<unsigned long long>(Percentile(all, 99)), static_cast<unsigned long long>(all.back()));
+    RecordProperty("requests_per_second", static_cast<int>(all.size() / seconds));
+    RecordProperty("latency_p50_us", static_cast<int>(Percentile(all, 50)));
+    RecordProperty("latency_p95_us", static_cast<int>(Percentile(all, 95)));
+    RecordProperty("latency_p99_us", static_cast<int>(Percentile(all, 99)));
+
+    EXPECT_EQ(0u, failures.load());
+    EXPECT_EQ(0u, unexpected.load());
+    EXPECT_EQ(0u, changeFailures.load());
+
+    // Let the write-behind and the notification handling catch up, then all three must agree
+    std::this_thread::sleep_for(std::chrono::milliseconds(STRESS_SETTLE_MS));
+
+    Core::JSON::String presentationLanguage;
+    EXPECT_EQ(Core::ERROR_NONE, InvokeServiceMethod("org.rdk.UserSettings", "getPresentationLanguage", presentationLanguage));
+
+    JsonObject params, result;
+    EXPECT_EQ(Core::ERROR_NONE, InvokeServiceMethod("org.rdk.UserPreferences", "getUILanguage", params, result));
+    const string uiLanguage = result["ui_language"].String();
+
+    const LanguagePair* expected = nullptr;
+    for (const LanguagePair& pair : StressLanguages) {
+        if (presentationLanguage.Value() == pair.PresentationLanguage) {
+            expected = &pair;
+        }
+    }
+    ASSERT_NE(nullptr, expected) << "Unexpected presentation language " << presentationLanguage.Value();
+    EXPECT_STREQ(expected->UILanguage, uiLanguage.c_str());
+    EXPECT_STREQ(expected->UILanguage, ReadFileUILanguage().c_str());
+}
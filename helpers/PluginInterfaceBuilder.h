@@ -22,6 +22,11 @@
 #include <core/Proxy.h>
 #include <plugins/IShell.h>
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+
 #include "UtilsLogging.h"
 
 namespace WPEFramework {
@@ -68,8 +73,11 @@ namespace Plugin {
         PluginInterfaceRef& operator=(PluginInterfaceRef&& other)
         {
             if (this != &other) {
+                Reset();
                 _interface = other._interface;
+                _service = other._service;
                 other._interface = nullptr;
+                other._service = nullptr;
             }
             return *this;
         }
@@ -84,6 +92,19 @@ namespace Plugin {
             return _interface;
         }
 
+        INTERFACE& operator*() const
+        {
+            return *_interface;
+        }
+
+        // hands the reference over to the caller, who becomes responsible for Release()
+        INTERFACE* Detach()
+        {
+            INTERFACE* result = _interface;
+            _interface = nullptr;
+            return result;
+        }
+
         void Reset()
         {
             if (_interface) {
@@ -107,10 +128,34 @@ namespace Plugin {
             return nullptr;
         }
 
-        auto pluginInterface = controller->QueryInterfaceByCallsign<INTERFACE>(callsign.c_str());
+        // QueryInterfaceByCallsign already hands out a counted reference. Keep
+        // polling until the target shows up or the configured timeout expires.
+        const uint32_t retryIntervalMs = 100;
+        uint32_t waitedMs = 0;
+        INTERFACE* pluginInterface = controller->QueryInterfaceByCallsign<INTERFACE>(callsign.c_str());
+
+        while ((pluginInterface == nullptr) && (waitedMs < builder.timeout())) {
+            const uint32_t sleepMs = std::min(retryIntervalMs, builder.timeout() - waitedMs);
+            SleepMs(sleepMs);
+            waitedMs += sleepMs;
+            pluginInterface = controller->QueryInterfaceByCallsign<INTERFACE>(callsign.c_str());
+        }
 
-        if (pluginInterface) {
-            pluginInterface->AddRef();
+        if ((pluginInterface != nullptr) && (builder.version() != static_cast<uint32_t>(~0))) {
+            // IShell::IsSupported() takes a uint8_t; a wider version must not wrap onto a supported one
+            bool supported = false;
+            if (builder.version() <= std::numeric_limits<uint8_t>::max()) {
+                PluginHost::IShell* target = controller->QueryInterfaceByCallsign<PluginHost::IShell>(callsign.c_str());
+                supported = (target != nullptr) && target->IsSupported(static_cast<uint8_t>(builder.version()));
+                if (target != nullptr) {
+                    target->Release();
+                }
+            }
+            if (!supported) {
+                LOGERR("%s does not support interface version %u", callsign.c_str(), builder.version());
+                pluginInterface->Release();
+                pluginInterface = nullptr;
+            }
         }
 
         return pluginInterface;
@@ -135,7 +180,7 @@ namespace Plugin {
             : _callsign(callsign)
             , _service(nullptr)
             , _version(static_cast<uint32_t>(~0))
-            , _timeout(3000)
+            , _timeout(0)
         {
         }
 
@@ -148,6 +193,7 @@ namespace Plugin {
             return *this;
         }
 
+        // How long createInterface() keeps polling for a target that is not up yet; 0, the default, doesn't wait
         inline PluginInterfaceBuilder& withTimeout(uint32_t timeoutMs)
         {
             _timeout = timeoutMs;
@@ -181,6 +227,153 @@ namespace Plugin {
         {
             return _service;
         }
+
+        uint32_t version() const
+        {
+            return _version;
+        }
+
+        uint32_t timeout() const
+        {
+            return _timeout;
+        }
+    };
+
+    /**
+     * @brief Keeps the interface of another plugin for the lifetime of the owner, so that
+     * it is queried (and its notification registered) once instead of on every use.
+     *
+     * The interface is resolved lazily on the first Acquire() and kept until Reset() or
+     * Invalidate() is called. Owners should call Invalidate() when the target plugin
+     * deactivates (IPlugin::INotification) and Reset() from their own Deinitialize().
+     */
+    template <typename INTERFACE>
+    class PluginInterfaceCache {
+    public:
+        using Callback = std::function<void(INTERFACE&)>;
+
+        PluginInterfaceCache(const char* callsign)
+            : _builder(callsign)
+            , _interface(nullptr)
+            , _onAcquired()
+            , _onReleasing()
+            , _generation(0)
+            , _lock()
+        {
+        }
+
+        ~PluginInterfaceCache()
+        {
+            Invalidate();
+        }
+
+        PluginInterfaceCache(const PluginInterfaceCache&) = delete;
+        PluginInterfaceCache& operator=(const PluginInterfaceCache&) = delete;
+
+        // Configure before the first Acquire()
+        PluginInterfaceBuilder<INTERFACE>& builder()
+        {
+            return _builder;
+        }
+
+        // Called once per resolved interface, e.g. to register a notification sink. Runs without
+        // the cache lock held, so it may call back into the cache.
+        void OnAcquired(Callback callback)
+        {
+            _onAcquired = std::move(callback);
+        }
+
+        // Called before a still valid interface is dropped by Reset(), without the cache lock held
+        void OnReleasing(Callback callback)
+        {
+            _onReleasing = std::move(callback);
+        }
+
+        // Returns a counted reference to the cached interface, resolving it when needed.
+        // The resolution runs without the cache lock, as it may poll for the builder's timeout.
+        PluginInterfaceRef<INTERFACE> Acquire()
+        {
+            bool published = false;
+
+            _lock.Lock();
+            INTERFACE* result = _interface;
+            const uint32_t generation = _generation;
+            if (result != nullptr) {
+                result->AddRef();
+            }
+            _lock.Unlock();
+
+            if (result == nullptr) {
+                INTERFACE* resolved = _builder.createInterface().Detach();
+                if (resolved != nullptr) {
+                    _lock.Lock();
+                    // Not published when dropped meanwhile, as it may already be stale
+                    if (generation == _generation) {
+                        if (_interface == nullptr) {
+                            _interface = resolved;
+                            published = true;
+                        }
+                        // Or the one another caller published first
+                        result = _interface;
+                        result->AddRef();
+                    }
+                    _lock.Unlock();
+                    if (!published) {
+                        resolved->Release();
+                    }
+                }
+            }
+
+            // The reference taken above keeps the interface alive even if it is invalidated meanwhile
+            if (published && _onAcquired) {
+                _onAcquired(*result);
+            }
+
+            return PluginInterfaceRef<INTERFACE>(result, _builder.controller());
+        }
+
+        bool IsValid() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            return (_interface != nullptr);
+        }
+
+        // Gracefully drops the interface, running the OnReleasing callback first
+        void Reset()
+        {
+            _lock.Lock();
+            INTERFACE* released = _interface;
+            _interface = nullptr;
+            _generation++;
+            _lock.Unlock();
+
+            if (released != nullptr) {
+                if (_onReleasing) {
+                    _onReleasing(*released);
+                }
+                released->Release();
+            }
+        }
+
+        // Drops the interface without calling into it, for when the target went away
+        void Invalidate()
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+
+            if (_interface != nullptr) {
+                _interface->Release();
+                _interface = nullptr;
+            }
+            _generation++;
+        }
+
+    private:
+        PluginInterfaceBuilder<INTERFACE> _builder;
+        INTERFACE* _interface;
+        Callback _onAcquired;
+        Callback _onReleasing;
+        uint32_t _generation;       // Bumped by Reset() and Invalidate(), so a resolution they overtook isn't published
+        mutable Core::CriticalSection _lock;
     };
 
 } // Plugin
@@ -23,11 +23,106 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
 namespace Utils
 {
+namespace Internal
+{
+// Bytes per copy_file_range/sendfile call; the data never enters user space
+static constexpr size_t MOVE_FILE_CHUNK = 8 * 1024 * 1024;
+
+enum class CopyResult {
+    DONE,
+    FAILED,
+    UNSUPPORTED     // neither call can copy between these files, nothing was written
+};
+
+/**
+* @brief Copies in to out until end of file with copy_file_range (in kernel, or a reflink on file
+* systems that share extents), or sendfile where copy_file_range is not available
+*/
+inline CopyResult KernelCopy(const int in, const int out)
+{
+    off_t copied = 0;
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 27))
+    bool copyFileRange = true;
+#else
+    bool copyFileRange = false;
+#endif
+
+    while (true) {
+        ssize_t count;
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 27))
+        if (copyFileRange) {
+            count = ::copy_file_range(in, nullptr, out, nullptr, MOVE_FILE_CHUNK, 0);
+            if ((count < 0) && (copied == 0) && ((errno == ENOSYS) || (errno == EXDEV) || (errno == EINVAL) || (errno == EOPNOTSUPP))) {
+                copyFileRange = false;
+                continue;
+            }
+        } else
+#endif
+        {
+            count = ::sendfile(out, in, nullptr, MOVE_FILE_CHUNK);
+            if ((count < 0) && (copied == 0) && ((errno == ENOSYS) || (errno == EINVAL))) {
+                return CopyResult::UNSUPPORTED;
+            }
+        }
+
+        if (count == 0) {
+            return CopyResult::DONE;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return CopyResult::FAILED;
+        }
+        copied += count;
+    }
+}
+
+/**
+* @brief rename(2) that fails with EEXIST rather than replace an existing destination, atomically:
+* renameat2(RENAME_NOREPLACE), or link(2) and unlink(2) where the kernel or file system lacks it
+*/
+inline bool RenameNoReplace(const char* from, const char* to)
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 28))
+    if (::renameat2(AT_FDCWD, from, AT_FDCWD, to, RENAME_NOREPLACE) == 0) {
+        return true;
+    }
+    if ((errno != EINVAL) && (errno != ENOSYS)) {
+        return false;
+    }
+#endif
+    if (::link(from, to) != 0) {
+        return false;
+    }
+    if (::unlink(from) != 0) {
+        const int error = errno;
+        ::unlink(to);
+        errno = error;
+        return false;
+    }
+    return true;
+}
+}
+
+/**
+* @brief Moves a file, creating the destination directory if needed. Fails if the destination
+* exists, also when it is created concurrently; a partial destination is removed on error. Tried
+* in order: a rename that doesn't replace, which only succeeds within one file system; a copy in
+* the kernel; a copy through a buffer.
+*/
 auto MoveFile(
     const string &from,
     const string &to) -> bool
@@ -39,10 +134,54 @@ auto MoveFile(
 
     Directory(fileTo.PathName().c_str()).CreatePath();
 
+    if (!fileFrom.Exists() || fileTo.Exists()) {
+        return false;
+    }
+
+    // Same file system: only the directory entry changes. EXDEV (and anything else) falls back to copying
+    if (Internal::RenameNoReplace(from.c_str(), to.c_str())) {
+        return true;
+    }
+    if (errno == EEXIST) {
+        return false;
+    }
+
+    const int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in >= 0) {
+        struct stat status;
+        const int out = (::fstat(in, &status) == 0)
+            ? ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, status.st_mode & 0777)
+            : -1;
+
+        Internal::CopyResult copy = Internal::CopyResult::UNSUPPORTED;
+        if (out >= 0) {
+            copy = Internal::KernelCopy(in, out);
+            if ((::close(out) != 0) && (copy == Internal::CopyResult::DONE)) {
+                copy = Internal::CopyResult::FAILED;
+            }
+            if (copy != Internal::CopyResult::DONE) {
+                ::unlink(to.c_str());
+            }
+        } else if (errno == EEXIST) {
+            copy = Internal::CopyResult::FAILED;
+        }
+        ::close(in);
+
+        if (copy == Internal::CopyResult::DONE) {
+            // A source that stays behind would leave the file duplicated rather than moved
+            if (::unlink(from.c_str()) == 0) {
+                return true;
+            }
+            ::unlink(to.c_str());
+            return false;
+        }
+        if (copy == Internal::CopyResult::FAILED) {
+            return false;
+        }
+    }
+
     bool result =
-        fileFrom.Exists() &&
-            !fileTo.Exists() &&
-            fileFrom.Open(true) &&
+        fileFrom.Open(true) &&
             fileTo.Create();
 
     if (result) {
@@ -73,9 +212,9 @@ auto MoveFile(
         while (result);
 
         if (result) {
-            fileFrom.Destroy();
+            result = fileFrom.Destroy();
         }
-        else {
+        if (!result) {
             fileTo.Destroy();
         }
     }
@@ -83,28 +222,63 @@ auto MoveFile(
     return result;
 }
 
+/**
+* @brief Get the last non empty line from a buffer, equivalent to "tr -s '\r' '\n' | tail -n 1".
+* Scans backward from the end, so only the last line is read and copied.
+* @param[in] data - The input, e.g. a memory mapped file; need not be '\0' terminated
+* @param[in] length - Size of the input in bytes
+* @param[out] res_str - The last non empty line, unchanged if there is none
+* @return whether or not a non empty line was found
+*/
+inline bool getLastLine(const char* data, const size_t length, std::string& res_str)
+{
+    size_t end = length;
+    while ((end > 0) && ((data[end - 1] == '\n') || (data[end - 1] == '\r'))) {
+        end--;
+    }
+    if (end == 0) {
+        return false;
+    }
+    size_t begin = end;
+    while ((begin > 0) && (data[begin - 1] != '\n') && (data[begin - 1] != '\r')) {
+        begin--;
+    }
+    res_str.assign(data + begin, end - begin);
+    return true;
+}
+
 /**
 * @brief Get the last non empty line from the input string, equivalent to "tr -s '\r' '\n' | tail -n 1"
 * @param[in] input - The input string
 * @param[out] res_str - The last non empty line from the input string
 * @return whether or not a non empty line was found
 */
-bool getLastLine(const std::string& input, std::string& res_str)
+inline bool getLastLine(const std::string& input, std::string& res_str)
 {
-    string read_line = "";
-    bool ret_value = false;
+    return getLastLine(input.data(), input.size(), res_str);
+}
 
-    if (!input.empty())
-    {
-        stringstream read_str(input);
-        while (getline(read_str, read_line, '\n'))
-        {
-            if (!read_line.empty())
-            {
-                res_str = read_line;
-                ret_value = true;
+/**
+* @brief Get the last non empty line of a file, mapped read only rather than read into memory
+* @param[in] path - The file
+* @param[out] res_str - The last non empty line of the file
+* @return whether or not a non empty line was found; false as well if the file can't be read
+*/
+inline bool getLastLineOfFile(const std::string& path, std::string& res_str)
+{
+    bool ret_value = false;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat status;
+        if ((::fstat(fd, &status) == 0) && (status.st_size > 0)) {
+            const size_t length = static_cast<size_t>(status.st_size);
+            void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (address != MAP_FAILED) {
+                ret_value = getLastLine(static_cast<const char*>(address), length, res_str);
+                ::munmap(address, length);
             }
         }
+        ::close(fd);
     }
     return ret_value;
 }
@@ -21,8 +21,199 @@
 
 #include "UtilsLogging.h"
 
-#define LOGINFOMETHOD() { std::string json; parameters.ToString(json); LOGINFO( "params=%s", json.c_str() ); }
-#define LOGTRACEMETHODFIN() { std::string json; response.ToString(json); LOGINFO( "response=%s", json.c_str() ); }
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace Utils {
+namespace JsonRpc {
+
+    enum class ParamStatus {
+        OK,
+        NOT_FOUND,      // no such key, or null
+        WRONG_TYPE,     // neither the JSON type nor a string holding the whole value in that type
+        OUT_OF_RANGE    // a number the target type can't hold
+    };
+
+    namespace Internal {
+
+        using Variant = WPEFramework::Core::JSON::Variant;
+
+        // Parses all of text with strto*: no exceptions, no allocation, like std::from_chars (C++17)
+        template <typename T>
+        ParamStatus Parse(const std::string& text, T& param, std::true_type /* signed */)
+        {
+            char* end = nullptr;
+            errno = 0;
+            const long long number = ::strtoll(text.c_str(), &end, 10);
+            if (text.empty() || (*end != '\0')) {
+                return ParamStatus::WRONG_TYPE;
+            }
+            if ((errno == ERANGE) || (number < std::numeric_limits<T>::min()) || (number > std::numeric_limits<T>::max())) {
+                return ParamStatus::OUT_OF_RANGE;
+            }
+            param = static_cast<T>(number);
+            return ParamStatus::OK;
+        }
+        template <typename T>
+        ParamStatus Parse(const std::string& text, T& param, std::false_type /* unsigned */)
+        {
+            char* end = nullptr;
+            errno = 0;
+            // strtoull accepts "-1" as ULLONG_MAX
+            const unsigned long long number = ::strtoull(text.c_str(), &end, 10);
+            if (text.empty() || (*end != '\0')) {
+                return ParamStatus::WRONG_TYPE;
+            }
+            if ((errno == ERANGE) || (text.find('-') != std::string::npos) || (number > std::numeric_limits<T>::max())) {
+                return ParamStatus::OUT_OF_RANGE;
+            }
+            param = static_cast<T>(number);
+            return ParamStatus::OK;
+        }
+
+        template <typename T, typename ENABLE = void>
+        struct Param;
+
+        // Integers: a JSON number, truncated toward zero as std::stoi did, or a string holding an integer
+        template <typename T>
+        struct Param<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+            static ParamStatus From(const Variant& value, T& param)
+            {
+                if (Variant::type::NUMBER == value.Content()) {
+                    const int64_t number = value.Number();
+                    if ((number < 0) ? (std::is_unsigned<T>::value || (number < static_cast<int64_t>(std::numeric_limits<T>::min())))
+                                     : (static_cast<uint64_t>(number) > static_cast<uint64_t>(std::numeric_limits<T>::max()))) {
+                        return ParamStatus::OUT_OF_RANGE;
+                    }
+                    param = static_cast<T>(number);
+                    return ParamStatus::OK;
+                }
+                if (Variant::type::FLOAT == value.Content()) {
+                    // min() and max() + 1 are powers of two, so exact as doubles; !(>=) also rejects NaN
+                    const double number = std::trunc(value.Double());
+                    if (!(number >= static_cast<double>(std::numeric_limits<T>::min())) || (number >= (static_cast<double>(std::numeric_limits<T>::max() / 2 + 1) * 2.0))) {
+                        return ParamStatus::OUT_OF_RANGE;
+                    }
+                    param = static_cast<T>(number);
+                    return ParamStatus::OK;
+                }
+                if (Variant::type::STRING == value.Content()) {
+                    return Parse(value.String(), param, std::integral_constant<bool, std::is_signed<T>::value>());
+                }
+                return ParamStatus::WRONG_TYPE;
+            }
+        };
+
+        // Floating point: any JSON number, or a string holding one
+        template <typename T>
+        struct Param<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+            static ParamStatus From(const Variant& value, T& param)
+            {
+                if ((Variant::type::FLOAT == value.Content()) || (Variant::type::NUMBER == value.Content())) {
+                    param = static_cast<T>(value.Double());
+                    return ParamStatus::OK;
+                }
+                if (Variant::type::STRING == value.Content()) {
+                    const std::string text = value.String();
+                    char* end = nullptr;
+                    errno = 0;
+                    const double number = ::strtod(text.c_str(), &end);
+                    if (text.empty() || (*end != '\0')) {
+                        return ParamStatus::WRONG_TYPE;
+                    }
+                    if ((errno == ERANGE) || (number < -std::numeric_limits<T>::max()) || (number > std::numeric_limits<T>::max())) {
+                        return ParamStatus::OUT_OF_RANGE;
+                    }
+                    param = static_cast<T>(number);
+                    return ParamStatus::OK;
+                }
+                return ParamStatus::WRONG_TYPE;
+            }
+        };
+
+        // Booleans: a JSON boolean, or "true", "false", "1", "0"
+        template <>
+        struct Param<bool> {
+            static ParamStatus From(const Variant& value, bool& param)
+            {
+                if (Variant::type::BOOLEAN == value.Content()) {
+                    param = value.Boolean();
+                    return ParamStatus::OK;
+                }
+                if (Variant::type::STRING == value.Content()) {
+                    const std::string text = value.String();
+                    if ((text == "true") || (text == "1")) {
+                        param = true;
+                        return ParamStatus::OK;
+                    }
+                    if ((text == "false") || (text == "0")) {
+                        param = false;
+                        return ParamStatus::OK;
+                    }
+                }
+                return ParamStatus::WRONG_TYPE;
+            }
+        };
+
+        // Strings: a JSON string only
+        template <>
+        struct Param<std::string> {
+            static ParamStatus From(const Variant& value, std::string& param)
+            {
+                if (Variant::type::STRING == value.Content()) {
+                    param = value.String();
+                    return ParamStatus::OK;
+                }
+                return ParamStatus::WRONG_TYPE;
+            }
+        };
+    }
+
+    /**
+    * @brief Extracts parameters[name] as a T (integer, floating point, bool or std::string) with a
+    * single lookup. param is only written on ParamStatus::OK.
+    */
+    template <typename T>
+    ParamStatus GetParam(const WPEFramework::Core::JSON::VariantContainer& parameters, const char* name, T& param)
+    {
+        const WPEFramework::Core::JSON::Variant& value = parameters.Get(name);
+        if (WPEFramework::Core::JSON::Variant::type::EMPTY == value.Content()) {
+            return ParamStatus::NOT_FOUND;
+        }
+        return Internal::Param<T>::From(value, param);
+    }
+
+    /**
+    * @brief As GetParam, but param receives fallback when the status is not ParamStatus::OK.
+    */
+    template <typename T>
+    ParamStatus GetParam(const WPEFramework::Core::JSON::VariantContainer& parameters, const char* name, T& param, const T& fallback)
+    {
+        const ParamStatus status = GetParam(parameters, name, param);
+        if (ParamStatus::OK != status) {
+            param = fallback;
+        }
+        return status;
+    }
+
+    /**
+    * @brief Whether parameters[name] exists with the given JSON type, with a single lookup.
+    */
+    inline bool HasParam(const WPEFramework::Core::JSON::VariantContainer& parameters, const char* name, const WPEFramework::Core::JSON::Variant::type type)
+    {
+        return (type == parameters.Get(name).Content());
+    }
+
+} // namespace JsonRpc
+} // namespace Utils
+
+// Only serialize the JSON when the line is going to be logged
+#define LOGINFOMETHOD() { if (::Utils::Logging::Enabled(LOG_LEVEL_INFO)) { std::string json; parameters.ToString(json); LOGINFO( "params=%s", json.c_str() ); } }
+#define LOGTRACEMETHODFIN() { if (::Utils::Logging::Enabled(LOG_LEVEL_INFO)) { std::string json; response.ToString(json); LOGINFO( "response=%s", json.c_str() ); } }
 
 /**
  * DO NOT USE THIS.
@@ -45,19 +236,19 @@
         returnResponse(false); \
     }
 #define returnIfStringParamNotFound(param, name) \
-    if (!param.HasLabel(name) || param[name].Content() != WPEFramework::Core::JSON::Variant::type::STRING) \
+    if (!::Utils::JsonRpc::HasParam(param, name, WPEFramework::Core::JSON::Variant::type::STRING)) \
     {\
         LOGERR("No argument '%s' or it has incorrect type", name); \
         returnResponse(false); \
     }
 #define returnIfBooleanParamNotFound(param, name) \
-    if (!param.HasLabel(name) || param[name].Content() != WPEFramework::Core::JSON::Variant::type::BOOLEAN) \
+    if (!::Utils::JsonRpc::HasParam(param, name, WPEFramework::Core::JSON::Variant::type::BOOLEAN)) \
     { \
         LOGERR("No argument '%s' or it has incorrect type", name); \
         returnResponse(false); \
     }
 #define returnIfNumberParamNotFound(param, name) \
-    if (!param.HasLabel(name) || param[name].Content() != WPEFramework::Core::JSON::Variant::type::NUMBER) \
+    if (!::Utils::JsonRpc::HasParam(param, name, WPEFramework::Core::JSON::Variant::type::NUMBER)) \
     { \
         LOGERR("No argument '%s' or it has incorrect type", name); \
         returnResponse(false); \
@@ -72,15 +263,15 @@
 #if ((THUNDER_VERSION >= 4) && (THUNDER_VERSION_MINOR == 4))
 
 #define sendNotify(event,params) { \
-    std::string json; \
-    params.ToString(json); \
-    LOGINFO("Notify %s %s", event, json.c_str()); \
+    if (::Utils::Logging::Enabled(LOG_LEVEL_INFO)) { \
+        std::string json; \
+        params.ToString(json); \
+        LOGINFO("Notify %s %s", event, json.c_str()); \
+    } \
     Notify(event,params); \
 }
 
 #define sendNotifyMaskParameters(event,params) { \
-    std::string json; \
-    params.ToString(json); \
     LOGINFO("Notify %s <***>", event); \
     Notify(event,params); \
 }
@@ -88,14 +279,14 @@
 #else
 
 #define sendNotify(event,params) { \
-    std::string json; \
-    params.ToString(json); \
-    LOGINFO("Notify %s %s", event, json.c_str()); \
+    if (::Utils::Logging::Enabled(LOG_LEVEL_INFO)) { \
+        std::string json; \
+        params.ToString(json); \
+        LOGINFO("Notify %s %s", event, json.c_str()); \
+    } \
     for (uint8_t i = 1; GetHandler(i); i++) GetHandler(i)->Notify(event,params); \
 }
 #define sendNotifyMaskParameters(event,params) { \
-    std::string json; \
-    params.ToString(json); \
     LOGINFO("Notify %s <***>", event); \
     for (uint8_t i = 1; GetHandler(i); i++) GetHandler(i)->Notify(event,params); \
 }
@@ -108,62 +299,30 @@
  * and use the generated classes from <interfaces/json/JsonData_YOURPLUGINNAME.h>
  */
 
-#define getNumberParameter(paramName, param) { \
-    if (WPEFramework::Core::JSON::Variant::type::NUMBER == parameters[paramName].Content()) \
-        param = parameters[paramName].Number(); \
-    else \
-        try { param = std::stoi( parameters[paramName].String()); } \
-        catch (...) { param = 0; } \
-}
+/* Shims over ::Utils::JsonRpc::GetParam for existing callers; new code should call GetParam and
+* branch on its status. Values that don't parse in full (e.g. "12abc") now give the fallback. */
+#define getNumberParameter(paramName, param) getNumberParameterObject(parameters, paramName, param)
 #define getNumberParameterObject(parameters, paramName, param) { \
-    if (WPEFramework::Core::JSON::Variant::type::NUMBER == parameters[paramName].Content()) \
-        param = parameters[paramName].Number(); \
-    else \
-        try {param = std::stoi( parameters[paramName].String());} \
-        catch (...) { param = 0; } \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param, static_cast<std::decay<decltype(param)>::type>(0)); \
 }
 #define getBoolParameter(paramName, param) { \
-    if (WPEFramework::Core::JSON::Variant::type::BOOLEAN == parameters[paramName].Content()) \
-        param = parameters[paramName].Boolean(); \
-    else \
-        param = parameters[paramName].String() == "true" || parameters[paramName].String() == "1"; \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param, false); \
 }
 #define getStringParameter(paramName, param) { \
-    if (WPEFramework::Core::JSON::Variant::type::STRING == parameters[paramName].Content()) \
-        param = parameters[paramName].String(); \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param); \
 }
 #define getFloatParameter(paramName, param) { \
-    if (Core::JSON::Variant::type::FLOAT == parameters[paramName].Content()) \
-        param = parameters[paramName].Float(); \
-    else \
-        try { param = std::stof( parameters[paramName].String()); } \
-        catch (...) { param = 0; } \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param, static_cast<std::decay<decltype(param)>::type>(0)); \
 }
 #define vectorSet(v,s) \
     if (find(begin(v), end(v), s) == end(v)) \
         v.emplace_back(s);
 #define getDefaultNumberParameter(paramName, param, default) { \
-    if (parameters.HasLabel(paramName)) { \
-        if (WPEFramework::Core::JSON::Variant::type::NUMBER == parameters[paramName].Content()) \
-            param = parameters[paramName].Number(); \
-        else \
-            try { param = std::stoi( parameters[paramName].String()); } \
-            catch (...) { param = default; } \
-    } else param = default; \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param, static_cast<std::decay<decltype(param)>::type>(default)); \
 }
 #define getDefaultStringParameter(paramName, param, default) { \
-    if (parameters.HasLabel(paramName)) { \
-        if (WPEFramework::Core::JSON::Variant::type::STRING == parameters[paramName].Content()) \
-            param = parameters[paramName].String(); \
-        else \
-            param = default; \
-    } else param = default; \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param, std::string(default)); \
 }
 #define getDefaultBoolParameter(paramName, param, default) { \
-    if (parameters.HasLabel(paramName)) { \
-        if (WPEFramework::Core::JSON::Variant::type::BOOLEAN == parameters[paramName].Content()) \
-            param = parameters[paramName].Boolean(); \
-        else \
-            param = parameters[paramName].String() == "true" || parameters[paramName].String() == "1"; \
-     } else param = default; \
+    ::Utils::JsonRpc::GetParam(parameters, paramName, param, static_cast<bool>(default)); \
 }
@@ -20,10 +20,327 @@
 #pragma once
 
 #include <syscall.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
 
-#define LOGINFO(fmt, ...) do { fprintf(stderr, "[%d] INFO [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), WPEFramework::Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGWARN(fmt, ...) do { fprintf(stderr, "[%d] WARN [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), WPEFramework::Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
-#define LOGERR(fmt, ...) do { fprintf(stderr, "[%d] ERROR [%s:%d] %s: " fmt "\n", (int)syscall(SYS_gettid), WPEFramework::Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); fflush(stderr); } while (0)
+/**
+* Logging backend for the LOG* macros.
+*
+* - Compile-time gating: lines above LOG_COMPILE_LEVEL are compiled out.
+* - Runtime gating: lines above Utils::Logging::Level() are skipped before their arguments are
+*   evaluated. The initial level comes from the LOG_LEVEL environment variable (ERROR, WARN or INFO).
+* - The thread id is read once per thread and cached.
+* - Lines are formatted into a slot of a lock-free ring buffer and written to stderr by a background
+*   thread, so callers never wait for stderr. When the ring is full the line is dropped and counted.
+*   The thread is joined (and the ring drained) when the library holding it is unloaded.
+* - Error lines are written on the caller's thread, after every line queued before them, so the
+*   lines leading up to an error are out before a crash that follows it. See Synchronous() for what
+*   is still lost on a crash.
+*
+* Define LOG_SYNCHRONOUS to write every line directly to stderr instead, as before.
+*/
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN  1
+#define LOG_LEVEL_INFO  2
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO
+#endif
+
+namespace Utils {
+namespace Logging {
+
+    inline int InitialLevel()
+    {
+        const char* level = ::getenv("LOG_LEVEL");
+        if (level == nullptr) {
+            return LOG_LEVEL_INFO;
+        }
+        if (::strcasecmp(level, "ERROR") == 0) {
+            return LOG_LEVEL_ERROR;
+        }
+        if (::strcasecmp(level, "WARN") == 0) {
+            return LOG_LEVEL_WARN;
+        }
+        return LOG_LEVEL_INFO;
+    }
+
+    inline std::atomic<int>& RuntimeLevel()
+    {
+        static std::atomic<int> level(InitialLevel());
+        return level;
+    }
+
+    inline int Level()
+    {
+        return RuntimeLevel().load(std::memory_order_relaxed);
+    }
+
+    inline void Level(const int level)
+    {
+        RuntimeLevel().store(level, std::memory_order_relaxed);
+    }
+
+    inline bool InitialSynchronous()
+    {
+        const char* synchronous = ::getenv("LOG_SYNCHRONOUS");
+        return ((synchronous != nullptr) && (synchronous[0] != '\0') && (::strcmp(synchronous, "0") != 0));
+    }
+
+    inline std::atomic<bool>& RuntimeSynchronous()
+    {
+        static std::atomic<bool> synchronous(InitialSynchronous());
+        return synchronous;
+    }
+
+    /**
+    * Whether every line is written on the caller's thread, as errors always are. Initially set by the
+    * LOG_SYNCHRONOUS environment variable (any value but 0).
+    *
+    * Off, callers don't wait for stderr, but lines still queued in the ring when the process crashes
+    * or aborts are lost: the INFO and WARN lines the drain thread had not yet written, since the last
+    * error line flushed them. Nothing is written from a signal handler, as the ring may be mid-update
+    * there. Turn it on while chasing a crash that logs no error first; every
+    * line then costs a stderr write and a lock shared with the other callers.
+    */
+    inline bool Synchronous()
+    {
+        return RuntimeSynchronous().load(std::memory_order_relaxed);
+    }
+
+    inline void Synchronous(const bool synchronous)
+    {
+        RuntimeSynchronous().store(synchronous, std::memory_order_relaxed);
+    }
+
+    inline bool Enabled(const int level)
+    {
+        return ((level <= LOG_COMPILE_LEVEL) && (level <= Level()));
+    }
+
+    inline pid_t ThreadId()
+    {
+        static thread_local const pid_t tid = static_cast<pid_t>(::syscall(SYS_gettid));
+        return tid;
+    }
+
+    /**
+    * @brief Bounded multi-producer, single-consumer ring of formatted lines, drained by its own thread.
+    */
+    class Sink {
+    public:
+        static constexpr uint32_t SLOTS = 1024;         // power of two
+        static constexpr uint32_t LINE_LENGTH = 512;    // longer lines are truncated
+
+        Sink(const Sink&) = delete;
+        Sink& operator=(const Sink&) = delete;
+
+        Sink()
+            : _head(0)
+            , _tail(0)
+            , _dropped(0)
+            , _running(true)
+            , _idle(false)
+            , _lock()
+            , _consumer()
+            , _signal()
+            , _thread()
+        {
+            for (uint32_t index = 0; index < SLOTS; index++) {
+                _slots[index].Sequence.store(index, std::memory_order_relaxed);
+            }
+            _thread = std::thread(&Sink::Drain, this);
+            State().store(ALIVE, std::memory_order_release);
+        }
+        ~Sink()
+        {
+            State().store(GONE, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> guard(_lock);
+                _running = false;
+            }
+            _signal.notify_one();
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        static Sink& Instance()
+        {
+            static Sink instance;
+            return instance;
+        }
+
+        enum lifetime : uint8_t {
+            UNBORN,
+            ALIVE,
+            GONE
+        };
+
+        // Trivially destructible, so still readable from destructors running after the Sink is gone
+        static std::atomic<uint8_t>& State()
+        {
+            static std::atomic<uint8_t> state(UNBORN);
+            return state;
+        }
+
+        void Write(const char* format, va_list arguments)
+        {
+            uint64_t position = _head.load(std::memory_order_relaxed);
+            Slot* slot = nullptr;
+            while (true) {
+                slot = &_slots[position & (SLOTS - 1)];
+                const uint64_t sequence = slot->Sequence.load(std::memory_order_acquire);
+                const int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+                if (difference == 0) {
+                    if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    _dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                } else {
+                    position = _head.load(std::memory_order_relaxed);
+                }
+            }
+
+            const int length = ::vsnprintf(slot->Text, sizeof(slot->Text), format, arguments);
+            slot->Length = (length < 0 ? 0 : (static_cast<uint32_t>(length) < sizeof(slot->Text) ? static_cast<uint32_t>(length) : (sizeof(slot->Text) - 1)));
+            if ((length > 0) && (slot->Text[slot->Length - 1] != '\n')) {
+                // Truncated: keep the line terminated
+                slot->Text[slot->Length - 1] = '\n';
+            }
+            slot->Sequence.store(position + 1, std::memory_order_release);
+
+            if (_idle.load(std::memory_order_acquire)) {
+                _signal.notify_one();
+            }
+        }
+
+        // Writes the queued lines and then this one, on the caller's thread
+        void WriteNow(const char* format, va_list arguments)
+        {
+            std::lock_guard<std::mutex> guard(_consumer);
+            Written();
+            ::vfprintf(stderr, format, arguments);
+            ::fflush(stderr);
+        }
+
+    private:
+        struct Slot {
+            std::atomic<uint64_t> Sequence;
+            uint32_t Length;
+            char Text[LINE_LENGTH];
+        };
+
+        // Writes every published line; returns the number written
+        uint32_t Flush()
+        {
+            std::lock_guard<std::mutex> guard(_consumer);
+            return Written();
+        }
+
+        // Flush() with _consumer held, by the drain thread or a caller writing synchronously
+        uint32_t Written()
+        {
+            uint32_t written = 0;
+            while (true) {
+                Slot& slot = _slots[_tail & (SLOTS - 1)];
+                if (slot.Sequence.load(std::memory_order_acquire) != (_tail + 1)) {
+                    break;
+                }
+                ::fwrite(slot.Text, 1, slot.Length, stderr);
+                slot.Sequence.store(_tail + SLOTS, std::memory_order_release);
+                _tail++;
+                written++;
+            }
+            const uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped != 0) {
+                ::fprintf(stderr, "[%d] WARN [UtilsLogging.h] Sink: %llu log lines dropped\n", static_cast<int>(ThreadId()), static_cast<unsigned long long>(dropped));
+            }
+            if ((written != 0) || (dropped != 0)) {
+                ::fflush(stderr);
+            }
+            return written;
+        }
+
+        void Drain()
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            while (_running) {
+                guard.unlock();
+                const uint32_t written = Flush();
+                guard.lock();
+                if ((written == 0) && _running) {
+                    // The timeout covers a producer that published just before _idle was raised
+                    _idle.store(true, std::memory_order_release);
+                    _signal.wait_for(guard, std::chrono::milliseconds(50));
+                    _idle.store(false, std::memory_order_release);
+                }
+            }
+            guard.unlock();
+            Flush();
+        }
+
+    private:
+        Slot _slots[SLOTS];
+        alignas(64) std::atomic<uint64_t> _head;
+        alignas(64) uint64_t _tail;
+        std::atomic<uint64_t> _dropped;
+        bool _running;
+        std::atomic<bool> _idle;
+        std::mutex _lock;
+        std::mutex _consumer;           // single consumer of the ring: the drain thread or WriteNow()
+        std::condition_variable _signal;
+        std::thread _thread;
+    };
+
+    inline void Write(const int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+    inline void Write(const int level, const char* format, ...)
+    {
+        va_list arguments;
+        va_start(arguments, format);
+#ifndef LOG_SYNCHRONOUS
+        // Once the Sink is destroyed (library unload, process exit) fall back to writing directly
+        if (Sink::State().load(std::memory_order_acquire) != Sink::GONE) {
+            if ((level == LOG_LEVEL_ERROR) || Synchronous()) {
+                Sink::Instance().WriteNow(format, arguments);
+            } else {
+                Sink::Instance().Write(format, arguments);
+            }
+            va_end(arguments);
+            return;
+        }
+#else
+        (void)level;
+#endif
+        ::vfprintf(stderr, format, arguments);
+        ::fflush(stderr);
+        va_end(arguments);
+    }
+
+} // namespace Logging
+} // namespace Utils
+
+#define LOG_AT(level, label, fmt, ...) do { \
+    if (::Utils::Logging::Enabled(level)) { \
+        ::Utils::Logging::Write(level, "[%d] " label " [%s:%d] %s: " fmt "\n", (int)::Utils::Logging::ThreadId(), WPEFramework::Core::FileNameOnly(__FILE__), __LINE__, __FUNCTION__, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+#define LOGINFO(fmt, ...) LOG_AT(LOG_LEVEL_INFO, "INFO", fmt, ##__VA_ARGS__)
+#define LOGWARN(fmt, ...) LOG_AT(LOG_LEVEL_WARN, "WARN", fmt, ##__VA_ARGS__)
+#define LOGERR(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, "ERROR", fmt, ##__VA_ARGS__)
 
 #define LOG_DEVICE_EXCEPTION0() LOGWARN("Exception caught: code=%d message=%s", err.getCode(), err.what());
 #define LOG_DEVICE_EXCEPTION1(param1) LOGWARN("Exception caught" #param1 "=%s code=%d message=%s", param1.c_str(), err.getCode(), err.what());
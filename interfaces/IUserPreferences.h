@@ -0,0 +1,153 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+
+// @insert <com/IIteratorType.h>
+
+namespace WPEFramework {
+namespace Exchange {
+
+    /* Method and parameter names are the ones of the JSON-RPC API that predates this interface,
+    * including the "success" result every method reports, so existing clients keep working. */
+
+    /* Not in <interfaces/Ids.h> yet: ID_ENTOS_OFFSET + 0x4E0 up to 0x4EF are claimed here for this
+    * interface and its iterators. They have to move to Ids.h, with the same values, once reserved
+    * there; until then no other interface may use that range. */
+    enum {
+        ID_USER_PREFERENCES = ID_ENTOS_OFFSET + 0x4E0,
+        ID_USER_PREFERENCES_NOTIFICATION = ID_USER_PREFERENCES + 1,
+        ID_USER_PREFERENCES_PREFERENCE_ITERATOR = ID_USER_PREFERENCES + 2,
+        ID_USER_PREFERENCES_CONTENT_ITERATOR = ID_USER_PREFERENCES + 3,
+        ID_USER_PREFERENCES_TRACK_ITERATOR = ID_USER_PREFERENCES + 4
+    };
+
+    // @json 1.0.0
+    struct EXTERNAL IUserPreferences : virtual public Core::IUnknown {
+        enum { ID = ID_USER_PREFERENCES };
+
+        // Only the member of the property's type is used; the others are false, empty or 0 when read
+        struct Preference {
+            string key /* @brief Property name (e.g. captions) */;
+            bool enabled /* @brief Value of a boolean property (e.g. true) */;
+            string text /* @brief Value of a string property (e.g. eng,fra) */;
+            double number /* @brief Value of a number property (e.g. 1.5) */;
+        };
+
+        using IPreferenceIterator = RPC::IIteratorType<Preference, ID_USER_PREFERENCES_PREFERENCE_ITERATOR>;
+
+        // Content descriptors of the TV Parental Guidelines, named as in the viewingRestrictions setting
+        enum ContentDescriptor : uint32_t {
+            DESCRIPTOR_DIALOGUE = 0x01,         // D
+            DESCRIPTOR_LANGUAGE = 0x02,         // L
+            DESCRIPTOR_SEXUAL_CONTENT = 0x04,   // S
+            DESCRIPTOR_VIOLENCE = 0x08,         // V
+            DESCRIPTOR_FANTASY_VIOLENCE = 0x10  // FV
+        };
+
+        struct Content {
+            string scheme /* @brief Rating scheme (e.g. US_TV) */;
+            string rating /* @brief Rating within the scheme, empty when not rated (e.g. TV-14) */;
+            uint32_t descriptorMask /* @brief ContentDescriptor bits of the content (e.g. 8) */;
+            int64_t airingTime /* @brief Seconds since the epoch, 0 for playback (e.g. 1767225600) */;
+        };
+
+        using IContentIterator = RPC::IIteratorType<Content, ID_USER_PREFERENCES_CONTENT_ITERATOR>;
+
+        enum TrackType : uint8_t {
+            TRACK_AUDIO /* @text audio */,
+            TRACK_CAPTIONS /* @text captions */
+        };
+
+        struct Track {
+            TrackType type /* @brief Audio or caption track (e.g. audio) */;
+            string language /* @brief Language of the track (e.g. eng) */;
+            string service /* @brief Caption service, empty for audio (e.g. CC1) */;
+            bool audioDescription /* @brief Audio track describing the video (e.g. false) */;
+        };
+
+        using ITrackIterator = RPC::IIteratorType<Track, ID_USER_PREFERENCES_TRACK_ITERATOR>;
+
+        // @event
+        struct EXTERNAL INotification : virtual public Core::IUnknown {
+            enum { ID = ID_USER_PREFERENCES_NOTIFICATION };
+
+            // @text onUILanguageChanged
+            // @brief The UI language changed, from any source
+            // @param ui_language: UI language in the legacy format (e.g. US_en)
+            virtual void OnUILanguageChanged(const string& ui_language) {};
+        };
+
+        virtual Core::hresult Register(Exchange::IUserPreferences::INotification* notification) = 0;
+        virtual Core::hresult Unregister(Exchange::IUserPreferences::INotification* notification) = 0;
+
+        // @text getUILanguage
+        // @brief Gets the UI language
+        // @param ui_language: UI language in the legacy format (e.g. US_en)
+        // @param success: Always true, the call fails otherwise
+        virtual Core::hresult GetUILanguage(string& ui_language /* @out */, bool& success /* @out */) = 0;
+
+        // @text setUILanguage
+        // @brief Sets the UI language, which UserSettings stores as its presentation language
+        // @param ui_language: UI language in the legacy format (e.g. US_en)
+        // @param success: Always true, the call fails otherwise
+        virtual Core::hresult SetUILanguage(const string& ui_language, bool& success /* @out */) = 0;
+
+        // @text getPreferences
+        // @brief Gets several UserSettings properties at once
+        // @param keys: Names of the properties to get, all of them when empty (e.g. ["captions", "voiceGuidanceRate"])
+        // @param preferences: The requested properties
+        // @param success: Always true, the call fails otherwise
+        virtual Core::hresult GetPreferences(RPC::IStringIterator* const keys, IPreferenceIterator*& preferences /* @out */, bool& success /* @out */) = 0;
+
+        // @text setPreferences
+        // @brief Sets several UserSettings properties at once; nothing is set if a name is unknown
+        // @param preferences: The properties to set
+        // @param failed: Names of the properties UserSettings refused
+        // @param success: False if UserSettings refused any property
+        virtual Core::hresult SetPreferences(IPreferenceIterator* const preferences, RPC::IStringIterator*& failed /* @out */, bool& success /* @out */) = 0;
+
+        // @text isContentAllowed
+        // @brief Evaluates the parental control settings for a batch of content, e.g. an EPG grid, in one call
+        // @param content: The entries to evaluate
+        // @param allowed: Bitmap in hex, bit n % 8 of byte n / 8 set when entry n may be shown (e.g. "05")
+        // @param success: Always true, the call fails otherwise
+        virtual Core::hresult IsContentAllowed(IContentIterator* const content, string& allowed /* @out */, bool& success /* @out */) = 0;
+
+        // @text selectTracks
+        // @brief Picks the audio and caption tracks that best match the track preferences, e.g. at stream start
+        // @param tracks: The tracks of the stream
+        // @param audio: Index of the audio track to play, -1 when there is none
+        // @param captions: Index of the caption track to show, -1 when there is none or captions are off
+        // @param success: Always true, the call fails otherwise
+        virtual Core::hresult SelectTracks(ITrackIterator* const tracks, int32_t& audio /* @out */, int32_t& captions /* @out */, bool& success /* @out */) = 0;
+
+        // @json:omit
+        // @brief Latency and error statistics per probe as a JSON object; ERROR_UNAVAILABLE when not built in
+        virtual Core::hresult GetMetrics(string& metrics /* @out */) = 0;
+
+        // @json:omit
+        // @brief Clears the statistics; ERROR_UNAVAILABLE when not built in
+        virtual Core::hresult ResetMetrics() = 0;
+    };
+
+} // namespace Exchange
+} // namespace WPEFramework
@@ -0,0 +1,175 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "FileWatcher.h"
+#include "UtilsLogging.h"
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        namespace {
+
+            // Written in place; or replaced, moved away or removed, each of which ends the watch on it
+            constexpr uint32_t FILE_EVENTS = (IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+            // Created or renamed into place, while there is no file to watch
+            constexpr uint32_t DIRECTORY_EVENTS = (IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO);
+
+        } // namespace
+
+        FileWatcher::FileWatcher()
+            : _fd(-1)
+            , _file(-1)
+            , _directory(-1)
+            , _path()
+            , _parent()
+            , _name()
+            , _changed()
+        {
+        }
+
+        FileWatcher::~FileWatcher()
+        {
+            Stop();
+        }
+
+        uint32_t FileWatcher::Start(const string& path, const std::function<void()>& changed)
+        {
+            ASSERT(_fd < 0);
+
+            const string::size_type separator = path.rfind('/');
+            _path = path;
+            _parent = (separator == string::npos ? string(".") : (separator == 0 ? string("/") : path.substr(0, separator)));
+            _name = (separator == string::npos ? path : path.substr(separator + 1));
+
+            _fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            if (_fd < 0) {
+                LOGERR("inotify_init1 failed: %s", strerror(errno));
+                return Core::ERROR_OPENING_FAILED;
+            }
+            Arm();
+            if ((_file < 0) && (_directory < 0)) {
+                close(_fd);
+                _fd = -1;
+                return Core::ERROR_OPENING_FAILED;
+            }
+
+            _changed = changed;
+            Core::ResourceMonitor::Instance().Register(*this);
+            return Core::ERROR_NONE;
+        }
+
+        void FileWatcher::Stop()
+        {
+            if (_fd >= 0) {
+                Core::ResourceMonitor::Instance().Unregister(*this);
+                close(_fd);
+                _fd = -1;
+                _file = -1;
+                _directory = -1;
+                _changed = nullptr;
+            }
+        }
+
+        /**
+        * @brief Watches the file at the path, or its directory while there is none.
+        * @return True if the path now refers to another file than the one watched so far.
+        */
+        bool FileWatcher::Arm()
+        {
+            // The same file gives the same watch back
+            const int file = inotify_add_watch(_fd, _path.c_str(), FILE_EVENTS);
+            if (file >= 0) {
+                const bool replaced = (file != _file);
+                if (replaced && (_file >= 0)) {
+                    // Already gone with a removed file
+                    inotify_rm_watch(_fd, _file);
+                }
+                if (_directory >= 0) {
+                    inotify_rm_watch(_fd, _directory);
+                    _directory = -1;
+                }
+                _file = file;
+                return replaced;
+            }
+
+            if (_file >= 0) {
+                inotify_rm_watch(_fd, _file);
+                _file = -1;
+            }
+            if (_directory < 0) {
+                _directory = inotify_add_watch(_fd, _parent.c_str(), DIRECTORY_EVENTS);
+                if (_directory < 0) {
+                    LOGERR("Failed to watch '%s': %s", _parent.c_str(), strerror(errno));
+                }
+            }
+            return false;
+        }
+
+        Core::IResource::handle FileWatcher::Descriptor() const
+        {
+            return _fd;
+        }
+
+        uint16_t FileWatcher::Events()
+        {
+            return (POLLIN);
+        }
+
+        void FileWatcher::Handle(const uint16_t events)
+        {
+            if ((events & POLLIN) == 0) {
+                return;
+            }
+
+            bool changed = false;
+            bool rearm = false;
+            // Aligned as the kernel writes struct inotify_event records into it
+            char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            ssize_t length;
+            while ((length = read(_fd, buffer, sizeof(buffer))) > 0) {
+                for (char* next = buffer; next < (buffer + length); ) {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(next);
+                    if (event->wd == _file) {
+                        changed = (changed || ((event->mask & IN_CLOSE_WRITE) != 0));
+                        // IN_ATTRIB also covers the link count dropping when the file is renamed over
+                        rearm = (rearm || ((event->mask & (IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) != 0));
+                    } else if ((event->wd == _directory) && (event->len > 0) && (_name == event->name)) {
+                        changed = true;
+                        rearm = true;
+                    }
+                    next += sizeof(struct inotify_event) + event->len;
+                }
+            }
+
+            if (rearm && Arm()) {
+                changed = true;
+            }
+            if (changed && _changed) {
+                _changed();
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,74 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include <functional>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief Reports writes to a file through inotify, serviced by Core::ResourceMonitor.
+        *
+        * The file itself is watched, not its directory, so writes to the other files there (the
+        * preferences file lives directly in /opt) don't wake the ResourceMonitor thread. Replacing
+        * the file (write to a temporary file and rename, as PreferenceStore and most editors do) or
+        * moving it away ends that watch: the path is then watched again, and a different file under
+        * it counts as a change. Only while there is no file at the path is the directory watched,
+        * for it to appear. The callback runs on the ResourceMonitor thread, once per batch of
+        * events, and must not block; it does not tell who wrote the file.
+        */
+        class FileWatcher : public Core::IResource {
+        public:
+            FileWatcher(const FileWatcher&) = delete;
+            FileWatcher& operator=(const FileWatcher&) = delete;
+
+            FileWatcher();
+            ~FileWatcher() override;
+
+            /**
+            * @return Core::ERROR_NONE, or Core::ERROR_OPENING_FAILED if inotify is not available or
+            *         the directory can't be watched.
+            */
+            uint32_t Start(const string& path, const std::function<void()>& changed);
+            // Waits for a running callback to complete
+            void Stop();
+
+            // Core::IResource
+            handle Descriptor() const override;
+            uint16_t Events() override;
+            void Handle(const uint16_t events) override;
+
+        private:
+            bool Arm();
+
+        private:
+            int _fd;
+            int _file;                  // watch on the file, -1 while there is none
+            int _directory;             // watch on its directory, only while there is no file
+            string _path;
+            string _parent;
+            string _name;
+            std::function<void()> _changed;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,283 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+* Conversion between the UserPreferences UI language format ("US_en") and the
+* UserSettings presentation language format ("en-US").
+*
+* Works on caller provided fixed-size buffers and never allocates. Language and
+* country parts are validated against the ISO 639-1 and ISO 3166-1 alpha-2 code
+* tables below, which are checked for ordering at compile time and searched with
+* a binary search. Kept free of Thunder dependencies so it can be benchmarked
+* and unit tested on its own.
+*/
+
+namespace WPEFramework {
+namespace Plugin {
+namespace LanguageCode {
+
+    constexpr size_t CODE_LENGTH = 5;                   // "US_en" or "en-US"
+    constexpr size_t BUFFER_SIZE = CODE_LENGTH + 1;     // including the terminating '\0'
+
+    namespace Table {
+
+        // ISO 639-1 language codes, sorted, 2 characters per entry
+        constexpr char Languages[] =
+            "aaabaeafakamanarasavayazbabebgbibmbnbobr"
+            "bscacechcocrcscucvcydadedvdzeeeleneoeset"
+            "eufafffifjfofrfygagdglgngugvhahehihohrht"
+            "huhyhziaidieigiiikioisitiujajvkakgkikjkk"
+            "klkmknkokrkskukvkwkylalblglilnloltlulvmg"
+            "mhmimkmlmnmrmsmtmynanbndnengnlnnnonrnvny"
+            "ocojomorospapiplpsptqurmrnrorurwsascsdse"
+            "sgsiskslsmsnsosqsrssstsusvswtatetgthtitk"
+            "tltntotrtstttwtyugukuruzvevivowawoxhyiyo"
+            "zazhzu";
+
+        // ISO 3166-1 alpha-2 country codes, sorted, 2 characters per entry
+        constexpr char Countries[] =
+            "ADAEAFAGAIALAMAOAQARASATAUAWAXAZBABBBDBE"
+            "BFBGBHBIBJBLBMBNBOBQBRBSBTBVBWBYBZCACCCD"
+            "CFCGCHCICKCLCMCNCOCRCUCVCWCXCYCZDEDJDKDM"
+            "DODZECEEEGEHERESETFIFJFKFMFOFRGAGBGDGEGF"
+            "GGGHGIGLGMGNGPGQGRGSGTGUGWGYHKHMHNHRHTHU"
+            "IDIEILIMINIOIQIRISITJEJMJOJPKEKGKHKIKMKN"
+            "KPKRKWKYKZLALBLCLILKLRLSLTLULVLYMAMCMDME"
+            "MFMGMHMKMLMMMNMOMPMQMRMSMTMUMVMWMXMYMZNA"
+            "NCNENFNGNINLNONPNRNUNZOMPAPEPFPGPHPKPLPM"
+            "PNPRPSPTPWPYQARERORSRURWSASBSCSDSESGSHSI"
+            "SJSKSLSMSNSOSRSSSTSVSXSYSZTCTDTFTGTHTJTK"
+            "TLTMTNTOTRTTTVTWTZUAUGUMUSUYUZVAVCVEVGVI"
+            "VNVUWFWSYEYTZAZMZW";
+
+        // ISO 639-2 codes (terminology and bibliographic) followed by their ISO 639-1 equivalent,
+        // sorted on the 3 letter code, 5 characters per entry
+        constexpr char Alpha3[] =
+            "aaraaabkabafrafakaakalbsqamhamaraararganarmhyasmasavaavaveae"
+            "aymayazeazbakbabambmbaqeubelbebenbnbisbibodbobosbsbrebrbulbg"
+            "burmycatcacescschachchecechizhchucuchvcvcorkwcoscocrecrcymcy"
+            "czecsdandadeudedivdvdutnldzodzellelengenepoeoesteteuseueweee"
+            "faofofasfafijfjfinfifrafrfrefrfryfyfulffgeokagerdeglagdglega"
+            "glgglglvgvgreelgrngngujguhaththauhahebheherhzhinhihmohohrvhr"
+            "hunhuhyehyiboigiceisidoioiiiiiikuiuileieinaiaindidipkikislis"
+            "itaitjavjvjpnjakalklkanknkaskskatkakaukrkazkkkhmkmkikkikinrw"
+            "kirkykomkvkonkgkorkokuakjkurkulaololatlalavlvlimlilinlnlitlt"
+            "ltzlblubluluglgmacmkmahmhmalmlmaomimarmrmaymsmkdmkmlgmgmltmt"
+            "monmnmrimimsamsmyamynaunanavnvnblnrndendndongnepnenldnlnnonn"
+            "nobnbnornonyanyociocojiojoriorormomossospanpaperfaplipipolpl"
+            "porptpuspsquequrohrmronrorumrorunrnrusrusagsgsansasinsislksk"
+            "sloskslvslsmesesmosmsnasnsndsdsomsosotstspaessqisqsrdscsrpsr"
+            "sswsssunsuswaswswesvtahtytamtatatttteltetgktgtgltlthathtibbo"
+            "tirtitontotsntntsotstuktkturtrtwitwuigugukrukurduruzbuzvenve"
+            "vievivolvowelcywlnwawolwoxhoxhyidyiyoryozhazazhozhzulzu";
+
+        constexpr size_t LANGUAGE_COUNT = (sizeof(Languages) - 1) / 2;
+        constexpr size_t COUNTRY_COUNT = (sizeof(Countries) - 1) / 2;
+        constexpr size_t ALPHA3_COUNT = (sizeof(Alpha3) - 1) / 5;
+
+        constexpr bool Less(const char* a, const char* b, const size_t length)
+        {
+            return (length != 0) && ((*a != *b) ? (*a < *b) : Less(a + 1, b + 1, length - 1));
+        }
+
+        constexpr bool IsSorted(const char* table, const size_t count, const size_t stride, const size_t keyLength, const size_t index = 1)
+        {
+            return (index >= count)
+                || (Less(table + ((index - 1) * stride), table + (index * stride), keyLength)
+                    && IsSorted(table, count, stride, keyLength, index + 1));
+        }
+
+        static_assert(((sizeof(Languages) - 1) % 2) == 0, "Languages entries must be 2 characters");
+        static_assert(((sizeof(Countries) - 1) % 2) == 0, "Countries entries must be 2 characters");
+        static_assert(((sizeof(Alpha3) - 1) % 5) == 0, "Alpha3 entries must be 5 characters");
+        static_assert(IsSorted(Languages, LANGUAGE_COUNT, 2, 2), "Languages must be sorted");
+        static_assert(IsSorted(Countries, COUNTRY_COUNT, 2, 2), "Countries must be sorted");
+        static_assert(IsSorted(Alpha3, ALPHA3_COUNT, 5, 3), "Alpha3 must be sorted");
+
+        // Keys are 2 or 3 characters, packed into an integer so every probe is a single compare
+        inline uint32_t Key(const char* text, const size_t length)
+        {
+            return (static_cast<uint32_t>(static_cast<unsigned char>(text[0])) << 16)
+                | (static_cast<uint32_t>(static_cast<unsigned char>(text[1])) << 8)
+                | ((length > 2) ? static_cast<unsigned char>(text[2]) : 0u);
+        }
+
+        // Binary search in a sorted fixed-stride table, returns the matching entry or nullptr
+        inline const char* Find(const char* table, const size_t count, const size_t stride, const char* key, const size_t keyLength)
+        {
+            const uint32_t wanted = Key(key, keyLength);
+            size_t low = 0;
+            size_t high = count;
+            while (low < high) {
+                const size_t middle = (low + high) / 2;
+                const uint32_t probe = Key(table + (middle * stride), keyLength);
+                if (probe == wanted) {
+                    return (table + (middle * stride));
+                }
+                if (probe < wanted) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return nullptr;
+        }
+
+    } // namespace Table
+
+    inline bool IsAlpha(const char c)
+    {
+        return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'));
+    }
+
+    inline char ToLower(const char c)
+    {
+        return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    inline char ToUpper(const char c)
+    {
+        return ((c >= 'a') && (c <= 'z')) ? static_cast<char>(c - 'a' + 'A') : c;
+    }
+
+    /**
+    * @brief Validates an ISO 639-1 ("en") or ISO 639-2 ("eng", "ger") language subtag, case insensitive.
+    * @param[out] language  The lower case ISO 639-1 code.
+    */
+    inline bool Language(const char* subtag, const size_t length, char (&language)[2])
+    {
+        char key[3];
+        for (size_t i = 0; i < length; i++) {
+            if ((length > sizeof(key)) || !IsAlpha(subtag[i])) {
+                return false;
+            }
+            key[i] = ToLower(subtag[i]);
+        }
+
+        if (length == 2) {
+            if (Table::Find(Table::Languages, Table::LANGUAGE_COUNT, 2, key, 2) == nullptr) {
+                return false;
+            }
+            language[0] = key[0];
+            language[1] = key[1];
+            return true;
+        }
+        if (length == 3) {
+            const char* entry = Table::Find(Table::Alpha3, Table::ALPHA3_COUNT, 5, key, 3);
+            if (entry == nullptr) {
+                return false;
+            }
+            language[0] = entry[3];
+            language[1] = entry[4];
+            return true;
+        }
+        return false;
+    }
+
+    /**
+    * @brief Validates an ISO 3166-1 alpha-2 country subtag ("US"), case insensitive.
+    * @param[out] country  The upper case code.
+    */
+    inline bool Country(const char* subtag, const size_t length, char (&country)[2])
+    {
+        if ((length != 2) || !IsAlpha(subtag[0]) || !IsAlpha(subtag[1])) {
+            return false;
+        }
+        const char key[2] = { ToUpper(subtag[0]), ToUpper(subtag[1]) };
+        if (Table::Find(Table::Countries, Table::COUNTRY_COUNT, 2, key, 2) == nullptr) {
+            return false;
+        }
+        country[0] = key[0];
+        country[1] = key[1];
+        return true;
+    }
+
+    /**
+    * @brief Converts a UI language ("US_en") to the presentation language format ("en-US").
+    * @param[in]  uiLanguage    Country code, '_' and language code, exactly 5 characters.
+    * @param[out] presentation  Receives the '\0' terminated result; untouched on failure.
+    * @return True if both codes are valid ISO codes.
+    */
+    inline bool ToPresentation(const char* uiLanguage, const size_t length, char (&presentation)[BUFFER_SIZE])
+    {
+        char country[2];
+        char language[2];
+        if ((length != CODE_LENGTH) || (uiLanguage[2] != '_')
+            || !Country(uiLanguage, 2, country) || !Language(uiLanguage + 3, 2, language)) {
+            return false;
+        }
+        presentation[0] = language[0];
+        presentation[1] = language[1];
+        presentation[2] = '-';
+        presentation[3] = country[0];
+        presentation[4] = country[1];
+        presentation[5] = '\0';
+        return true;
+    }
+
+    /**
+    * @brief Converts a presentation language to the UI language format ("US_en").
+    * @param[in]  presentationLanguage  "en-US", or one of the forms UserSettings may hand back:
+    *                                   a 3 letter language ("eng-US") and/or a script subtag
+    *                                   ("zh-Hans-CN"). The script does not fit the UI format and is dropped.
+    * @param[out] uiLanguage            Receives the '\0' terminated result; untouched on failure.
+    * @return True if the input is well formed and both codes are valid ISO codes.
+    */
+    inline bool ToUI(const char* presentationLanguage, const size_t length, char (&uiLanguage)[BUFFER_SIZE])
+    {
+        size_t languageLength = 0;
+        while ((languageLength < length) && (presentationLanguage[languageLength] != '-')) {
+            languageLength++;
+        }
+
+        char language[2];
+        if (!Language(presentationLanguage, languageLength, language)) {
+            return false;
+        }
+
+        size_t position = languageLength + 1;
+        // Skip a 4 letter script subtag ("Hans", "Latn") when one sits between language and region
+        if ((length == (position + 4 + 1 + 2)) && (presentationLanguage[position + 4] == '-')
+            && IsAlpha(presentationLanguage[position]) && IsAlpha(presentationLanguage[position + 1])
+            && IsAlpha(presentationLanguage[position + 2]) && IsAlpha(presentationLanguage[position + 3])) {
+            position += 5;
+        }
+
+        char country[2];
+        if ((length != (position + 2)) || !Country(presentationLanguage + position, 2, country)) {
+            return false;
+        }
+
+        uiLanguage[0] = country[0];
+        uiLanguage[1] = country[1];
+        uiLanguage[2] = '_';
+        uiLanguage[3] = language[0];
+        uiLanguage[4] = language[1];
+        uiLanguage[5] = '\0';
+        return true;
+    }
+
+} // namespace LanguageCode
+} // namespace Plugin
+} // namespace WPEFramework
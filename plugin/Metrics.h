@@ -0,0 +1,274 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+
+/**
+* Hot path instrumentation: per probe call and error counters plus a latency histogram.
+*
+* Opt-in: built with USERPREFERENCES_METRICS (cmake -DPLUGIN_USERPREFERENCES_METRICS=ON, default
+* OFF). Without it Registry and Scope are empty and every call inlines to nothing.
+*
+* Samples are recorded with relaxed atomic increments into one of SHARDS cache line aligned
+* shards, picked per thread, so concurrent requests don't contend on the same counters.
+* The histogram has power of two microsecond buckets; percentiles report the upper bound
+* of the bucket they fall in, the maximum is exact.
+*/
+
+namespace WPEFramework {
+    namespace Plugin {
+        namespace Metrics {
+
+            enum Probe : uint8_t {
+                GET_UI_LANGUAGE,
+                SET_UI_LANGUAGE,
+                GET_PREFERENCES,
+                SET_PREFERENCES,
+                IS_CONTENT_ALLOWED,
+                SELECT_TRACKS,
+                QUERY_INTERFACE,
+                GET_PRESENTATION_LANGUAGE,
+                SET_PRESENTATION_LANGUAGE,
+                FILE_SAVE,
+                NOTIFICATION,
+                PROBES
+            };
+
+            inline const TCHAR* Name(const Probe probe)
+            {
+                static const TCHAR* const names[PROBES] = {
+                    _T("getUILanguage"),
+                    _T("setUILanguage"),
+                    _T("getPreferences"),
+                    _T("setPreferences"),
+                    _T("isContentAllowed"),
+                    _T("selectTracks"),
+                    _T("QueryInterfaceByCallsign"),
+                    _T("GetPresentationLanguage"),
+                    _T("SetPresentationLanguage"),
+                    _T("FileSave"),
+                    _T("OnPresentationLanguageChanged")
+                };
+                return (probe < PROBES ? names[probe] : _T("unknown"));
+            }
+
+            struct Summary {
+                uint64_t Count;
+                uint64_t Errors;
+                uint64_t P50;       // microseconds
+                uint64_t P95;       // microseconds
+                uint64_t P99;       // microseconds
+                uint64_t Max;       // microseconds
+            };
+
+#ifdef USERPREFERENCES_METRICS
+
+            class Registry {
+            public:
+                static constexpr uint8_t SHARDS = 8;
+                static constexpr uint8_t BUCKETS = 32;  // bucket n holds samples below 2^n us, the last one the rest
+
+                Registry(const Registry&) = delete;
+                Registry& operator=(const Registry&) = delete;
+
+                Registry()
+                    : _storage()
+                    , _shards(reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(_storage) + (CACHE_LINE - 1)) & ~static_cast<uintptr_t>(CACHE_LINE - 1)))
+                {
+                    for (uint8_t shard = 0; shard < SHARDS; shard++) {
+                        new (_shards + (shard * SHARD_SIZE)) ShardData();
+                    }
+                    Reset();
+                }
+                ~Registry() = default;
+
+                void Record(const Probe probe, const uint64_t microseconds, const bool failed)
+                {
+                    Counters& counters = Data(Shard()).Probes[probe];
+                    counters.Count.fetch_add(1, std::memory_order_relaxed);
+                    if (failed) {
+                        counters.Errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    counters.Buckets[Bucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+                    uint64_t max = counters.Max.load(std::memory_order_relaxed);
+                    while ((microseconds > max)
+                        && !counters.Max.compare_exchange_weak(max, microseconds, std::memory_order_relaxed)) {
+                    }
+                }
+
+                Summary Get(const Probe probe) const
+                {
+                    Summary summary = {};
+                    uint64_t buckets[BUCKETS] = {};
+                    for (uint8_t shard = 0; shard < SHARDS; shard++) {
+                        const Counters& counters = Data(shard).Probes[probe];
+                        summary.Count += counters.Count.load(std::memory_order_relaxed);
+                        summary.Errors += counters.Errors.load(std::memory_order_relaxed);
+                        const uint64_t max = counters.Max.load(std::memory_order_relaxed);
+                        summary.Max = (max > summary.Max ? max : summary.Max);
+                        for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+                            buckets[bucket] += counters.Buckets[bucket].load(std::memory_order_relaxed);
+                        }
+                    }
+                    summary.P50 = Percentile(buckets, 50, summary.Max);
+                    summary.P95 = Percentile(buckets, 95, summary.Max);
+                    summary.P99 = Percentile(buckets, 99, summary.Max);
+                    return summary;
+                }
+
+                // Not atomic as a whole: samples recorded while resetting may partly survive
+                void Reset()
+                {
+                    for (uint8_t shard = 0; shard < SHARDS; shard++) {
+                        for (uint8_t probe = 0; probe < PROBES; probe++) {
+                            Counters& counters = Data(shard).Probes[probe];
+                            counters.Count.store(0, std::memory_order_relaxed);
+                            counters.Errors.store(0, std::memory_order_relaxed);
+                            counters.Max.store(0, std::memory_order_relaxed);
+                            for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+                                counters.Buckets[bucket].store(0, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                }
+
+            private:
+                struct Counters {
+                    std::atomic<uint64_t> Count;
+                    std::atomic<uint64_t> Errors;
+                    std::atomic<uint64_t> Max;
+                    std::atomic<uint64_t> Buckets[BUCKETS];
+                };
+
+                struct ShardData {
+                    Counters Probes[PROBES];
+                };
+
+                static constexpr size_t CACHE_LINE = 64;
+                // Rounded up, so no two shards share a cache line
+                static constexpr size_t SHARD_SIZE = ((sizeof(ShardData) + (CACHE_LINE - 1)) / CACHE_LINE) * CACHE_LINE;
+
+                ShardData& Data(const uint8_t shard) { return *reinterpret_cast<ShardData*>(_shards + (shard * SHARD_SIZE)); }
+                const ShardData& Data(const uint8_t shard) const { return *reinterpret_cast<const ShardData*>(_shards + (shard * SHARD_SIZE)); }
+
+                static uint8_t Shard()
+                {
+                    static std::atomic<uint8_t> next(0);
+                    static thread_local const uint8_t shard = (next.fetch_add(1, std::memory_order_relaxed) % SHARDS);
+                    return shard;
+                }
+
+                static uint8_t Bucket(uint64_t microseconds)
+                {
+                    uint8_t bucket = 0;
+                    while ((microseconds != 0) && (bucket < (BUCKETS - 1))) {
+                        microseconds >>= 1;
+                        bucket++;
+                    }
+                    return bucket;
+                }
+
+                static uint64_t Percentile(const uint64_t (&buckets)[BUCKETS], const uint8_t percent, const uint64_t max)
+                {
+                    uint64_t total = 0;
+                    for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+                        total += buckets[bucket];
+                    }
+                    const uint64_t rank = ((total * percent) + 99) / 100;
+                    uint64_t seen = 0;
+                    for (uint8_t bucket = 0; (bucket < BUCKETS) && (rank != 0); bucket++) {
+                        seen += buckets[bucket];
+                        if (seen >= rank) {
+                            const uint64_t upper = (bucket == 0 ? 0 : ((static_cast<uint64_t>(1) << bucket) - 1));
+                            return (upper < max ? upper : max);
+                        }
+                    }
+                    return 0;
+                }
+
+            private:
+                // alignas() on the shards is not honoured for the heap-allocated object holding the
+                // registry, as C++11 operator new only guarantees fundamental alignment; the shards
+                // are placed on cache line boundaries within this buffer instead
+                uint8_t _storage[(SHARDS * SHARD_SIZE) + (CACHE_LINE - 1)];
+                uint8_t* const _shards;
+            };
+
+            /**
+            * @brief Times its own lifetime and records it for a probe when it goes out of scope.
+            */
+            class Scope {
+            public:
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+
+                Scope(Registry& registry, const Probe probe)
+                    : _registry(registry)
+                    , _probe(probe)
+                    , _failed(false)
+                    , _start(std::chrono::steady_clock::now())
+                {
+                }
+                ~Scope()
+                {
+                    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - _start;
+                    _registry.Record(_probe, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), _failed);
+                }
+
+                void Failed() { _failed = true; }
+                void Result(const uint32_t status) { _failed = (status != Core::ERROR_NONE); }
+
+            private:
+                Registry& _registry;
+                const Probe _probe;
+                bool _failed;
+                const std::chrono::steady_clock::time_point _start;
+            };
+
+#else
+
+            class Registry {
+            public:
+                void Record(const Probe, const uint64_t, const bool) {}
+                Summary Get(const Probe) const { return Summary(); }
+                void Reset() {}
+            };
+
+            class Scope {
+            public:
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+
+                Scope(Registry&, const Probe) {}
+                ~Scope() = default;
+
+                void Failed() {}
+                void Result(const uint32_t) {}
+            };
+
+#endif
+
+        } // namespace Metrics
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,180 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "PreferenceStore.h"
+#include "UtilsLogging.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        PreferenceStore::PreferenceStore(const string& group)
+            : _group(group)
+            , _path()
+            , _policy(FsyncPolicy::DATA)
+            , _written()
+            , _lock()
+        {
+        }
+
+        void PreferenceStore::Configure(const string& path, const FsyncPolicy policy) {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _path = path;
+            _policy = policy;
+        }
+
+        uint32_t PreferenceStore::Get(const string& key, string& value) const {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+
+            g_autoptr(GKeyFile) file = g_key_file_new();
+            g_autoptr(GError) error = nullptr;
+            if (!g_key_file_load_from_file(file, _path.c_str(), G_KEY_FILE_NONE, &error)) {
+                if (G_FILE_ERROR_NOENT == error->code) {
+                    return Core::ERROR_UNAVAILABLE;
+                }
+                LOGERR("Failed to load file '%s': %s", _path.c_str(), error->message);
+                return Core::ERROR_READ_ERROR;
+            }
+
+            g_autofree gchar* val = g_key_file_get_string(file, _group.c_str(), key.c_str(), &error);
+            if (val == nullptr) {
+                LOGERR("Failed to read '%s' from file '%s': %s", key.c_str(), _path.c_str(), error->message);
+                return Core::ERROR_UNKNOWN_KEY;
+            }
+            value = val;
+            return Core::ERROR_NONE;
+        }
+
+        uint32_t PreferenceStore::Set(const string& key, const string& value) {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+
+            // Start from what is on disk so the other keys survive; a missing or corrupt file is simply replaced
+            g_autofree gchar* current = nullptr;
+            gsize currentLength = 0;
+            g_autoptr(GKeyFile) file = g_key_file_new();
+            if (g_file_get_contents(_path.c_str(), &current, &currentLength, nullptr)) {
+                g_key_file_load_from_data(file, current, currentLength, G_KEY_FILE_NONE, nullptr);
+            }
+
+            g_key_file_set_string(file, _group.c_str(), key.c_str(), value.c_str());
+            gsize length = 0;
+            g_autofree gchar* data = g_key_file_to_data(file, &length, nullptr);
+
+            if ((current != nullptr) && (currentLength == length) && (memcmp(current, data, length) == 0)) {
+                LOGINFO("'%s' is already '%s' in '%s', no file update needed", key.c_str(), value.c_str(), _path.c_str());
+                _written.assign(data, length);
+                return Core::ERROR_NONE;
+            }
+
+            if (!Replace(data, length)) {
+                return Core::ERROR_WRITE_ERROR;
+            }
+            _written.assign(data, length);
+            return Core::ERROR_NONE;
+        }
+
+        bool PreferenceStore::GetExternalChange(const string& key, string& value) const {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+
+            g_autofree gchar* current = nullptr;
+            gsize currentLength = 0;
+            if (!g_file_get_contents(_path.c_str(), &current, &currentLength, nullptr)) {
+                return false;
+            }
+            if ((currentLength == _written.length()) && (memcmp(current, _written.c_str(), currentLength) == 0)) {
+                return false;
+            }
+
+            g_autoptr(GKeyFile) file = g_key_file_new();
+            if (!g_key_file_load_from_data(file, current, currentLength, G_KEY_FILE_NONE, nullptr)) {
+                LOGWARN("'%s' was changed externally but can't be parsed", _path.c_str());
+                return false;
+            }
+            g_autofree gchar* val = g_key_file_get_string(file, _group.c_str(), key.c_str(), nullptr);
+            if (val == nullptr) {
+                return false;
+            }
+            value = val;
+            return true;
+        }
+
+        bool PreferenceStore::Replace(const char* data, const size_t length) const {
+            const string temporary = _path + ".tmp";
+
+            int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                LOGERR("Failed to create '%s': %s", temporary.c_str(), strerror(errno));
+                return false;
+            }
+
+            bool result = true;
+            size_t written = 0;
+            while (result && (written < length)) {
+                ssize_t count = write(fd, data + written, length - written);
+                if (count > 0) {
+                    written += count;
+                } else if (count == 0) {
+                    // No progress and no errno to retry on, e.g. a full device; don't spin under _lock
+                    LOGERR("Failed to write '%s': no bytes written", temporary.c_str());
+                    result = false;
+                } else if (errno != EINTR) {
+                    LOGERR("Failed to write '%s': %s", temporary.c_str(), strerror(errno));
+                    result = false;
+                }
+            }
+
+            if (result && (FsyncPolicy::DATA == _policy) && (fdatasync(fd) != 0)) {
+                LOGERR("fdatasync '%s' failed: %s", temporary.c_str(), strerror(errno));
+                result = false;
+            } else if (result && (FsyncPolicy::FULL == _policy) && (fsync(fd) != 0)) {
+                LOGERR("fsync '%s' failed: %s", temporary.c_str(), strerror(errno));
+                result = false;
+            }
+            close(fd);
+
+            if (result && (rename(temporary.c_str(), _path.c_str()) != 0)) {
+                LOGERR("Failed to rename '%s' to '%s': %s", temporary.c_str(), _path.c_str(), strerror(errno));
+                result = false;
+            }
+            if (!result) {
+                unlink(temporary.c_str());
+                return false;
+            }
+
+            if (FsyncPolicy::FULL == _policy) {
+                g_autofree gchar* directory = g_path_get_dirname(_path.c_str());
+                int dirFd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (dirFd >= 0) {
+                    if (fsync(dirFd) != 0) {
+                        LOGWARN("fsync of directory '%s' failed: %s", directory, strerror(errno));
+                    }
+                    close(dirFd);
+                }
+            }
+            return true;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,85 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief Key/value store on top of the legacy INI-style preferences file
+        * (e.g. "[General]\nui_language=US_en\n").
+        *
+        * Set() is the only write path: it renders the file, compares it with the bytes on
+        * disk and skips the write when they match. Otherwise the file is replaced atomically
+        * through a temporary file and rename(), synced according to the FsyncPolicy.
+        */
+        class PreferenceStore {
+        public:
+            enum class FsyncPolicy : uint8_t {
+                NONE,   // leave it to the kernel
+                DATA,   // fdatasync() the file before the rename
+                FULL    // fsync() the file and its directory, so the rename itself is durable
+            };
+
+            PreferenceStore(const PreferenceStore&) = delete;
+            PreferenceStore& operator=(const PreferenceStore&) = delete;
+
+            PreferenceStore(const string& group);
+            ~PreferenceStore() = default;
+
+            void Configure(const string& path, const FsyncPolicy policy);
+            const string& Path() const { return _path; }
+
+            /**
+            * @brief Reads a key from the file.
+            * @return Core::ERROR_NONE on success, Core::ERROR_UNAVAILABLE if the file does not exist,
+            *         Core::ERROR_UNKNOWN_KEY if the file has no such key, Core::ERROR_READ_ERROR otherwise.
+            */
+            uint32_t Get(const string& key, string& value) const;
+
+            /**
+            * @brief Stores a key, keeping the other keys of the file.
+            * @return Core::ERROR_NONE if the file holds the value (written or already up to date),
+            *         Core::ERROR_WRITE_ERROR otherwise.
+            */
+            uint32_t Set(const string& key, const string& value);
+
+            /**
+            * @brief Reads a key from a file someone else changed, i.e. one that no longer holds what
+            * Set() last left in it; used to tell external edits from the store's own writes.
+            * @return True if the file was changed externally and has the key.
+            */
+            bool GetExternalChange(const string& key, string& value) const;
+
+        private:
+            bool Replace(const char* data, const size_t length) const;
+
+        private:
+            const string _group;
+            string _path;
+            FsyncPolicy _policy;
+            string _written;    // File contents after the last Set()
+            mutable Core::CriticalSection _lock;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
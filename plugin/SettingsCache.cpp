@@ -0,0 +1,220 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "SettingsCache.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        namespace {
+
+            enum class Type : uint8_t {
+                BOOLEAN,
+                STRING,
+                NUMBER
+            };
+
+            struct Descriptor {
+                const TCHAR* Key;
+                Type Kind;
+            };
+
+            // Indexed by SettingsCache::Setting
+            const Descriptor Descriptors[SettingsCache::SETTINGS] = {
+                { _T("audioDescription"), Type::BOOLEAN },
+                { _T("preferredAudioLanguages"), Type::STRING },
+                { _T("presentationLanguage"), Type::STRING },
+                { _T("captions"), Type::BOOLEAN },
+                { _T("preferredCaptionsLanguages"), Type::STRING },
+                { _T("preferredClosedCaptionService"), Type::STRING },
+                { _T("pinControl"), Type::BOOLEAN },
+                { _T("viewingRestrictions"), Type::STRING },
+                { _T("viewingRestrictionsWindow"), Type::STRING },
+                { _T("liveWatershed"), Type::BOOLEAN },
+                { _T("playbackWatershed"), Type::BOOLEAN },
+                { _T("blockNotRatedContent"), Type::BOOLEAN },
+                { _T("pinOnPurchase"), Type::BOOLEAN },
+                { _T("highContrast"), Type::BOOLEAN },
+                { _T("voiceGuidance"), Type::BOOLEAN },
+                { _T("voiceGuidanceRate"), Type::NUMBER },
+                { _T("voiceGuidanceHints"), Type::BOOLEAN }
+            };
+
+        }
+
+        SettingsCache::SettingsCache()
+            : _values()
+            , _valid()
+            , _lock()
+        {
+        }
+
+        const TCHAR* SettingsCache::Key(const Setting setting) {
+            return (setting < SETTINGS ? Descriptors[setting].Key : _T(""));
+        }
+
+        bool SettingsCache::Find(const string& key, Setting& setting) {
+            for (uint8_t index = 0; index < SETTINGS; index++) {
+                if (key == Descriptors[index].Key) {
+                    setting = static_cast<Setting>(index);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool SettingsCache::IsValid(const Setting setting, const JsonValue& value) {
+            if (setting >= SETTINGS) {
+                return false;
+            }
+            switch (Descriptors[setting].Kind) {
+            case Type::BOOLEAN:
+                return (JsonValue::type::BOOLEAN == value.Content());
+            case Type::STRING:
+                return (JsonValue::type::STRING == value.Content());
+            case Type::NUMBER:
+                // Integral or floating point, whichever the parser picked
+                return ((JsonValue::type::EMPTY != value.Content())
+                    && (JsonValue::type::BOOLEAN != value.Content())
+                    && (JsonValue::type::STRING != value.Content())
+                    && (JsonValue::type::ARRAY != value.Content())
+                    && (JsonValue::type::OBJECT != value.Content()));
+            }
+            return false;
+        }
+
+        void SettingsCache::ToPreference(const Setting setting, const JsonValue& value, Exchange::IUserPreferences::Preference& preference) {
+            preference.key = Key(setting);
+            preference.enabled = false;
+            preference.text.clear();
+            preference.number = 0;
+            if (setting < SETTINGS) {
+                switch (Descriptors[setting].Kind) {
+                case Type::BOOLEAN: preference.enabled = value.Boolean(); break;
+                case Type::STRING:  preference.text = value.String(); break;
+                case Type::NUMBER:  preference.number = value.Double(); break;
+                }
+            }
+        }
+
+        JsonValue SettingsCache::FromPreference(const Setting setting, const Exchange::IUserPreferences::Preference& preference) {
+            if (setting < SETTINGS) {
+                switch (Descriptors[setting].Kind) {
+                case Type::BOOLEAN: return JsonValue(preference.enabled);
+                case Type::STRING:  return JsonValue(preference.text);
+                case Type::NUMBER:  return JsonValue(preference.number);
+                }
+            }
+            return JsonValue();
+        }
+
+        uint32_t SettingsCache::Fetch(Exchange::IUserSettings& userSettings, const Setting setting, JsonValue& value) {
+            uint32_t status = Core::ERROR_UNKNOWN_KEY;
+            bool enabled = false;
+            string text;
+            double number = 0;
+
+            switch (setting) {
+            case AUDIO_DESCRIPTION:                 status = userSettings.GetAudioDescription(enabled); break;
+            case PREFERRED_AUDIO_LANGUAGES:         status = userSettings.GetPreferredAudioLanguages(text); break;
+            case PRESENTATION_LANGUAGE:             status = userSettings.GetPresentationLanguage(text); break;
+            case CAPTIONS:                          status = userSettings.GetCaptions(enabled); break;
+            case PREFERRED_CAPTIONS_LANGUAGES:      status = userSettings.GetPreferredCaptionsLanguages(text); break;
+            case PREFERRED_CLOSED_CAPTION_SERVICE:  status = userSettings.GetPreferredClosedCaptionService(text); break;
+            case PIN_CONTROL:                       status = userSettings.GetPinControl(enabled); break;
+            case VIEWING_RESTRICTIONS:              status = userSettings.GetViewingRestrictions(text); break;
+            case VIEWING_RESTRICTIONS_WINDOW:       status = userSettings.GetViewingRestrictionsWindow(text); break;
+            case LIVE_WATERSHED:                    status = userSettings.GetLiveWatershed(enabled); break;
+            case PLAYBACK_WATERSHED:                status = userSettings.GetPlaybackWatershed(enabled); break;
+            case BLOCK_NOT_RATED_CONTENT:           status = userSettings.GetBlockNotRatedContent(enabled); break;
+            case PIN_ON_PURCHASE:                   status = userSettings.GetPinOnPurchase(enabled); break;
+            case HIGH_CONTRAST:                     status = userSettings.GetHighContrast(enabled); break;
+            case VOICE_GUIDANCE:                    status = userSettings.GetVoiceGuidance(enabled); break;
+            case VOICE_GUIDANCE_RATE:               status = userSettings.GetVoiceGuidanceRate(number); break;
+            case VOICE_GUIDANCE_HINTS:              status = userSettings.GetVoiceGuidanceHints(enabled); break;
+            default:                                return status;
+            }
+
+            if (Core::ERROR_NONE == status) {
+                switch (Descriptors[setting].Kind) {
+                case Type::BOOLEAN: value = JsonValue(enabled); break;
+                case Type::STRING:  value = JsonValue(text); break;
+                case Type::NUMBER:  value = JsonValue(number); break;
+                }
+            }
+            return status;
+        }
+
+        uint32_t SettingsCache::Apply(Exchange::IUserSettings& userSettings, const Setting setting, const JsonValue& value) {
+            if (!IsValid(setting, value)) {
+                return Core::ERROR_BAD_REQUEST;
+            }
+
+            const bool enabled = (Type::BOOLEAN == Descriptors[setting].Kind ? value.Boolean() : false);
+            const string text = (Type::STRING == Descriptors[setting].Kind ? value.String() : string());
+            const double number = (Type::NUMBER == Descriptors[setting].Kind ? value.Double() : 0);
+
+            switch (setting) {
+            case AUDIO_DESCRIPTION:                 return userSettings.SetAudioDescription(enabled);
+            case PREFERRED_AUDIO_LANGUAGES:         return userSettings.SetPreferredAudioLanguages(text);
+            case PRESENTATION_LANGUAGE:             return userSettings.SetPresentationLanguage(text);
+            case CAPTIONS:                          return userSettings.SetCaptions(enabled);
+            case PREFERRED_CAPTIONS_LANGUAGES:      return userSettings.SetPreferredCaptionsLanguages(text);
+            case PREFERRED_CLOSED_CAPTION_SERVICE:  return userSettings.SetPreferredClosedCaptionService(text);
+            case PIN_CONTROL:                       return userSettings.SetPinControl(enabled);
+            case VIEWING_RESTRICTIONS:              return userSettings.SetViewingRestrictions(text);
+            case VIEWING_RESTRICTIONS_WINDOW:       return userSettings.SetViewingRestrictionsWindow(text);
+            case LIVE_WATERSHED:                    return userSettings.SetLiveWatershed(enabled);
+            case PLAYBACK_WATERSHED:                return userSettings.SetPlaybackWatershed(enabled);
+            case BLOCK_NOT_RATED_CONTENT:           return userSettings.SetBlockNotRatedContent(enabled);
+            case PIN_ON_PURCHASE:                   return userSettings.SetPinOnPurchase(enabled);
+            case HIGH_CONTRAST:                     return userSettings.SetHighContrast(enabled);
+            case VOICE_GUIDANCE:                    return userSettings.SetVoiceGuidance(enabled);
+            case VOICE_GUIDANCE_RATE:               return userSettings.SetVoiceGuidanceRate(number);
+            case VOICE_GUIDANCE_HINTS:              return userSettings.SetVoiceGuidanceHints(enabled);
+            default:                                return Core::ERROR_UNKNOWN_KEY;
+            }
+        }
+
+        bool SettingsCache::Get(const Setting setting, JsonValue& value) const {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            if ((setting < SETTINGS) && _valid[setting]) {
+                value = _values[setting];
+                return true;
+            }
+            return false;
+        }
+
+        void SettingsCache::Update(const Setting setting, const JsonValue& value) {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            if (setting < SETTINGS) {
+                _values[setting] = value;
+                _valid[setting] = true;
+            }
+        }
+
+        void SettingsCache::Invalidate() {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            for (uint8_t index = 0; index < SETTINGS; index++) {
+                _valid[index] = false;
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
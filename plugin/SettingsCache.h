@@ -0,0 +1,88 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include <interfaces/IUserPreferences.h>
+#include <interfaces/IUserSettings.h>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief In-memory copy of the IUserSettings properties served by getPreferences/setPreferences.
+        *
+        * Entries are filled by a live read or a successful write and then kept current by the
+        * IUserSettings notifications, so they are only valid while those are registered.
+        * Keys are the property names UserSettings uses on its own JSON-RPC interface.
+        */
+        class SettingsCache {
+        public:
+            enum Setting : uint8_t {
+                AUDIO_DESCRIPTION,
+                PREFERRED_AUDIO_LANGUAGES,
+                PRESENTATION_LANGUAGE,
+                CAPTIONS,
+                PREFERRED_CAPTIONS_LANGUAGES,
+                PREFERRED_CLOSED_CAPTION_SERVICE,
+                PIN_CONTROL,
+                VIEWING_RESTRICTIONS,
+                VIEWING_RESTRICTIONS_WINDOW,
+                LIVE_WATERSHED,
+                PLAYBACK_WATERSHED,
+                BLOCK_NOT_RATED_CONTENT,
+                PIN_ON_PURCHASE,
+                HIGH_CONTRAST,
+                VOICE_GUIDANCE,
+                VOICE_GUIDANCE_RATE,
+                VOICE_GUIDANCE_HINTS,
+                SETTINGS
+            };
+
+            SettingsCache(const SettingsCache&) = delete;
+            SettingsCache& operator=(const SettingsCache&) = delete;
+
+            SettingsCache();
+            ~SettingsCache() = default;
+
+            static const TCHAR* Key(const Setting setting);
+            static bool Find(const string& key, Setting& setting);
+            // True if the value has the JSON type of the setting (boolean, string or number)
+            static bool IsValid(const Setting setting, const JsonValue& value);
+            // Between a value and the IUserPreferences::Preference member of the setting's type
+            static void ToPreference(const Setting setting, const JsonValue& value, Exchange::IUserPreferences::Preference& preference);
+            static JsonValue FromPreference(const Setting setting, const Exchange::IUserPreferences::Preference& preference);
+
+            // Live read from / write to UserSettings; the cache itself is not touched
+            static uint32_t Fetch(Exchange::IUserSettings& userSettings, const Setting setting, JsonValue& value);
+            static uint32_t Apply(Exchange::IUserSettings& userSettings, const Setting setting, const JsonValue& value);
+
+            bool Get(const Setting setting, JsonValue& value) const;
+            void Update(const Setting setting, const JsonValue& value);
+            void Invalidate();
+
+        private:
+            JsonValue _values[SETTINGS];
+            bool _valid[SETTINGS];
+            mutable Core::CriticalSection _lock;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,183 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "SnapshotPublisher.h"
+#include "UtilsLogging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        namespace {
+
+            // Boolean settings with a snapshot flag
+            UserPreferencesSnapshot::Field Flag(const SettingsCache::Setting setting)
+            {
+                switch (setting) {
+                case SettingsCache::AUDIO_DESCRIPTION:      return UserPreferencesSnapshot::AUDIO_DESCRIPTION;
+                case SettingsCache::CAPTIONS:               return UserPreferencesSnapshot::CAPTIONS;
+                case SettingsCache::HIGH_CONTRAST:          return UserPreferencesSnapshot::HIGH_CONTRAST;
+                case SettingsCache::VOICE_GUIDANCE:         return UserPreferencesSnapshot::VOICE_GUIDANCE;
+                case SettingsCache::VOICE_GUIDANCE_HINTS:   return UserPreferencesSnapshot::VOICE_GUIDANCE_HINTS;
+                default:                                    return static_cast<UserPreferencesSnapshot::Field>(0);
+                }
+            }
+
+            template <size_t SIZE>
+            bool Copy(char (&destination)[SIZE], const string& source)
+            {
+                if (source.length() >= SIZE) {
+                    return false;
+                }
+                ::memset(destination, 0, SIZE);
+                ::memcpy(destination, source.c_str(), source.length());
+                return true;
+            }
+
+        }
+
+        SnapshotPublisher::SnapshotPublisher()
+            : _layout(nullptr)
+            , _data()
+            , _lock()
+        {
+        }
+
+        SnapshotPublisher::~SnapshotPublisher()
+        {
+            Close();
+        }
+
+        uint32_t SnapshotPublisher::Open(const string& path)
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            ASSERT(nullptr == _layout);
+
+            const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                LOGERR("Failed to open snapshot '%s': %s", path.c_str(), strerror(errno));
+                return Core::ERROR_OPENING_FAILED;
+            }
+
+            void* address = MAP_FAILED;
+            if (::ftruncate(fd, sizeof(UserPreferencesSnapshot::Layout)) == 0) {
+                address = ::mmap(nullptr, sizeof(UserPreferencesSnapshot::Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            if (MAP_FAILED == address) {
+                LOGERR("Failed to map snapshot '%s': %s", path.c_str(), strerror(errno));
+                ::close(fd);
+                return Core::ERROR_OPENING_FAILED;
+            }
+            ::close(fd);
+
+            _layout = static_cast<UserPreferencesSnapshot::Layout*>(address);
+            ::memset(&_data, 0, sizeof(_data));
+            if (UserPreferencesSnapshot::MAGIC != _layout->Magic.load(std::memory_order_acquire)) {
+                // New file: zero filled by ftruncate, so the sequence starts at 0
+                _layout->LayoutVersion = UserPreferencesSnapshot::LAYOUT_VERSION;
+                _layout->Size = sizeof(UserPreferencesSnapshot::Layout);
+                _layout->Magic.store(UserPreferencesSnapshot::MAGIC, std::memory_order_release);
+            } else if ((_layout->Sequence.load(std::memory_order_relaxed) & 1) != 0) {
+                // A previous instance died mid-write; make the counter even again
+                _layout->Sequence.fetch_add(1, std::memory_order_relaxed);
+            }
+            // Whatever a previous instance left is not known to be current
+            Publish();
+            LOGINFO("Publishing preferences snapshot in '%s'", path.c_str());
+            return Core::ERROR_NONE;
+        }
+
+        void SnapshotPublisher::Close()
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            if (nullptr != _layout) {
+                ::memset(&_data, 0, sizeof(_data));
+                Publish();
+                ::munmap(_layout, sizeof(UserPreferencesSnapshot::Layout));
+                _layout = nullptr;
+            }
+        }
+
+        void SnapshotPublisher::SetUILanguage(const string& uiLanguage)
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            if (Copy(_data.UILanguage, uiLanguage)) {
+                _data.Valid |= UserPreferencesSnapshot::UI_LANGUAGE;
+            } else {
+                _data.Valid &= ~UserPreferencesSnapshot::UI_LANGUAGE;
+            }
+            Publish();
+        }
+
+        void SnapshotPublisher::ClearUILanguage()
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _data.Valid &= ~UserPreferencesSnapshot::UI_LANGUAGE;
+            Publish();
+        }
+
+        void SnapshotPublisher::Set(const SettingsCache::Setting setting, const JsonValue& value)
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            const UserPreferencesSnapshot::Field flag = Flag(setting);
+            if (0 != flag) {
+                _data.Valid |= flag;
+                if (value.Boolean()) {
+                    _data.Flags |= flag;
+                } else {
+                    _data.Flags &= ~flag;
+                }
+            } else if (SettingsCache::VOICE_GUIDANCE_RATE == setting) {
+                _data.VoiceGuidanceRate = value.Double();
+                _data.Valid |= UserPreferencesSnapshot::VOICE_GUIDANCE_RATE;
+            } else if (SettingsCache::PRESENTATION_LANGUAGE == setting) {
+                if (Copy(_data.PresentationLanguage, value.String())) {
+                    _data.Valid |= UserPreferencesSnapshot::PRESENTATION_LANGUAGE;
+                } else {
+                    _data.Valid &= ~UserPreferencesSnapshot::PRESENTATION_LANGUAGE;
+                }
+            } else {
+                return;
+            }
+            Publish();
+        }
+
+        void SnapshotPublisher::ClearSettings()
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _data.Valid &= UserPreferencesSnapshot::UI_LANGUAGE;
+            Publish();
+        }
+
+        // Called with _lock held
+        void SnapshotPublisher::Publish()
+        {
+            if (nullptr != _layout) {
+                UserPreferencesSnapshot::Store(*_layout, _data);
+            }
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
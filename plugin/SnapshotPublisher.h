@@ -0,0 +1,71 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include "SettingsCache.h"
+#include <snapshot/UserPreferencesSnapshot.h>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief Publishes the cached preferences into the shared memory snapshot read by native
+        * processes (snapshot/UserPreferencesSnapshot.h).
+        *
+        * Every change rewrites the whole 48 byte payload under the seqlock; changes are rare, so
+        * that is cheaper than tracking what changed. Without Open(), or if it failed, all calls
+        * are no-ops.
+        */
+        class SnapshotPublisher {
+        public:
+            SnapshotPublisher(const SnapshotPublisher&) = delete;
+            SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+            SnapshotPublisher();
+            ~SnapshotPublisher();
+
+            /**
+            * @brief Maps the file, creating it if needed. An existing file is reused so the
+            * mappings of running readers stay valid; its fields are cleared until set again.
+            * @return Core::ERROR_NONE, or Core::ERROR_OPENING_FAILED.
+            */
+            uint32_t Open(const string& path);
+            // Clears all fields, so readers see no stale values, and unmaps the file
+            void Close();
+
+            void SetUILanguage(const string& uiLanguage);
+            void ClearUILanguage();
+            // Settings without a snapshot field are ignored
+            void Set(const SettingsCache::Setting setting, const JsonValue& value);
+            // All fields but the UI language, which is cached separately
+            void ClearSettings();
+
+        private:
+            void Publish();
+
+        private:
+            UserPreferencesSnapshot::Layout* _layout;
+            UserPreferencesSnapshot::Data _data;
+            Core::CriticalSection _lock;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
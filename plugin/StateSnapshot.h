@@ -0,0 +1,180 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include "LanguageCode.h"
+#include <atomic>
+
+/**
+* The state every request reads: the cached UI language, the migration state and whether
+* UserSettings is up, i.e. whether requests look its interface up at all.
+*
+* All of it is packed into one 64-bit word: the 5 characters of the UI language, a flags byte and a
+* 16-bit version. Readers take a consistent view with a single atomic load, on any thread and
+* without a lock; writers replace the whole word with a compare-exchange. Every change bumps the
+* version, which wraps, so it only tells whether the state changed between two views.
+*/
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        class StateSnapshot {
+        public:
+            enum class MigrationState : uint8_t {
+                PENDING,    // not started yet, or waiting for a retry
+                RUNNING,    // PerformMigration in progress on the migration thread
+                DONE,
+                FAILED      // gave up after MIGRATION_MAX_ATTEMPTS, re-armed when UserSettings reactivates
+            };
+
+            /**
+            * @brief Immutable copy of the state, as taken by StateSnapshot::Get().
+            */
+            class View {
+            public:
+                explicit View(const uint64_t word) : _word(word) {}
+                ~View() = default;
+
+                uint16_t Version() const { return static_cast<uint16_t>(_word >> VERSION_SHIFT); }
+                MigrationState Migration() const { return static_cast<MigrationState>((_word >> FLAGS_SHIFT) & MIGRATION_MASK); }
+                bool IsUserSettingsAvailable() const { return (((_word >> FLAGS_SHIFT) & USERSETTINGS_AVAILABLE) != 0); }
+
+                // False when no UI language is cached
+                bool UILanguage(string& uiLanguage) const
+                {
+                    if (((_word >> FLAGS_SHIFT) & UILANGUAGE_VALID) == 0) {
+                        return false;
+                    }
+                    char language[LanguageCode::CODE_LENGTH];
+                    for (uint8_t index = 0; index < LanguageCode::CODE_LENGTH; index++) {
+                        language[index] = static_cast<char>(_word >> (index * 8));
+                    }
+                    uiLanguage.assign(language, LanguageCode::CODE_LENGTH);
+                    return true;
+                }
+
+            private:
+                uint64_t _word;
+            };
+
+            StateSnapshot(const StateSnapshot&) = delete;
+            StateSnapshot& operator=(const StateSnapshot&) = delete;
+
+            StateSnapshot() : _word(0) {}
+            ~StateSnapshot() = default;
+
+            View Get() const { return View(_word.load(std::memory_order_acquire)); }
+
+            // uiLanguage in UserPreferences format, as returned by LanguageCode::ToUI
+            void SetUILanguage(const string& uiLanguage)
+            {
+                ASSERT(uiLanguage.length() == LanguageCode::CODE_LENGTH);
+                uint64_t language = 0;
+                for (uint8_t index = 0; index < LanguageCode::CODE_LENGTH; index++) {
+                    language |= (static_cast<uint64_t>(static_cast<uint8_t>(uiLanguage[index])) << (index * 8));
+                }
+                Modify([language](uint64_t& word) {
+                    word = (word & ~LANGUAGE_BITS) | language | (static_cast<uint64_t>(UILANGUAGE_VALID) << FLAGS_SHIFT);
+                    return true;
+                });
+            }
+            void ClearUILanguage()
+            {
+                Modify([](uint64_t& word) {
+                    word &= ~(LANGUAGE_BITS | (static_cast<uint64_t>(UILANGUAGE_VALID) << FLAGS_SHIFT));
+                    return true;
+                });
+            }
+            void SetUserSettingsAvailable(const bool available)
+            {
+                Modify([available](uint64_t& word) {
+                    const uint64_t flag = (static_cast<uint64_t>(USERSETTINGS_AVAILABLE) << FLAGS_SHIFT);
+                    word = (available ? (word | flag) : (word & ~flag));
+                    return true;
+                });
+            }
+            // Only if nothing changed since view was taken, so a failed lookup can't undo a newer activation
+            bool ClearUserSettingsAvailable(const View& view)
+            {
+                const uint16_t version = view.Version();
+                return Modify([version](uint64_t& word) {
+                    if (View(word).Version() != version) {
+                        return false;
+                    }
+                    word &= ~(static_cast<uint64_t>(USERSETTINGS_AVAILABLE) << FLAGS_SHIFT);
+                    return true;
+                });
+            }
+            void SetMigration(const MigrationState state)
+            {
+                Modify([state](uint64_t& word) {
+                    word = (word & ~(static_cast<uint64_t>(MIGRATION_MASK) << FLAGS_SHIFT))
+                        | (static_cast<uint64_t>(state) << FLAGS_SHIFT);
+                    return true;
+                });
+            }
+            // Like std::atomic::compare_exchange_strong: on failure, expected receives the current state
+            bool ExchangeMigration(MigrationState& expected, const MigrationState desired)
+            {
+                return Modify([&expected, desired](uint64_t& word) {
+                    const MigrationState current = View(word).Migration();
+                    if (current != expected) {
+                        expected = current;
+                        return false;
+                    }
+                    word = (word & ~(static_cast<uint64_t>(MIGRATION_MASK) << FLAGS_SHIFT))
+                        | (static_cast<uint64_t>(desired) << FLAGS_SHIFT);
+                    return true;
+                });
+            }
+
+        private:
+            static constexpr uint8_t FLAGS_SHIFT = 40;
+            static constexpr uint8_t VERSION_SHIFT = 48;
+            static constexpr uint8_t MIGRATION_MASK = 0x03;
+            static constexpr uint8_t UILANGUAGE_VALID = 0x04;
+            static constexpr uint8_t USERSETTINGS_AVAILABLE = 0x08;
+            static constexpr uint64_t LANGUAGE_BITS = ((static_cast<uint64_t>(1) << FLAGS_SHIFT) - 1);
+
+            // Applies change to the current word and publishes the result with the next version,
+            // retrying when another writer got in between. Nothing is published if change returns false.
+            template <typename CHANGE>
+            bool Modify(CHANGE change)
+            {
+                uint64_t current = _word.load(std::memory_order_acquire);
+                uint64_t next;
+                do {
+                    next = current;
+                    if (!change(next)) {
+                        return false;
+                    }
+                    const uint64_t version = static_cast<uint16_t>(View(current).Version() + 1);
+                    next = (next & ~(static_cast<uint64_t>(0xFFFF) << VERSION_SHIFT)) | (version << VERSION_SHIFT);
+                } while (!_word.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire));
+                return true;
+            }
+
+        private:
+            std::atomic<uint64_t> _word;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,221 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "TrackPreferences.h"
+#include "LanguageCode.h"
+
+#include <algorithm>
+
+#define TRACK_LANGUAGE_SEPARATOR        ','
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        struct TrackPreferences::Index {
+            Index()
+                : Audio()
+                , Captions()
+                , Service()
+                , CaptionsEnabled(false)
+                , AudioDescription(false)
+            {
+            }
+
+            std::vector<uint32_t> Audio;        // language keys, most preferred first
+            std::vector<uint32_t> Captions;     // language keys, most preferred first
+            string Service;
+            bool CaptionsEnabled;
+            bool AudioDescription;
+        };
+
+        constexpr uint8_t TrackPreferences::INPUTS;
+
+        namespace {
+
+            // Index into TrackPreferences::_inputs, in the order of Inputs()
+            enum InputIndex : uint8_t {
+                PREFERRED_AUDIO_LANGUAGES,
+                PREFERRED_CAPTIONS_LANGUAGES,
+                PREFERRED_CLOSED_CAPTION_SERVICE,
+                CAPTIONS,
+                AUDIO_DESCRIPTION
+            };
+
+            // Marks keys of ISO 639-2 codes that have no ISO 639-1 equivalent
+            constexpr uint32_t ALPHA3_KEY = 0x01000000;
+
+            // Language rank, then the secondary criterion; the lowest score wins
+            inline uint32_t Score(const std::vector<uint32_t>& preferred, const uint32_t language, const bool secondaryMatch)
+            {
+                const size_t rank = ((language != 0) ? (std::find(preferred.begin(), preferred.end(), language) - preferred.begin()) : preferred.size());
+                return ((static_cast<uint32_t>(rank) << 1) | (secondaryMatch ? 0 : 1));
+            }
+
+        } // namespace
+
+        TrackPreferences::TrackPreferences()
+            : _inputs()
+            , _known(0)
+            , _index(Compile(_inputs, 0))
+            , _lock()
+        {
+        }
+
+        /* static */ const std::vector<SettingsCache::Setting>& TrackPreferences::Inputs()
+        {
+            // In the order of InputIndex
+            static const std::vector<SettingsCache::Setting> inputs = {
+                SettingsCache::PREFERRED_AUDIO_LANGUAGES,
+                SettingsCache::PREFERRED_CAPTIONS_LANGUAGES,
+                SettingsCache::PREFERRED_CLOSED_CAPTION_SERVICE,
+                SettingsCache::CAPTIONS,
+                SettingsCache::AUDIO_DESCRIPTION
+            };
+            return inputs;
+        }
+
+        /* static */ int8_t TrackPreferences::IndexOf(const SettingsCache::Setting setting)
+        {
+            const std::vector<SettingsCache::Setting>& inputs = Inputs();
+            for (uint8_t index = 0; index < inputs.size(); index++) {
+                if (inputs[index] == setting) {
+                    return static_cast<int8_t>(index);
+                }
+            }
+            return -1;
+        }
+
+        void TrackPreferences::Update(const SettingsCache::Setting setting, const JsonValue& value)
+        {
+            const int8_t input = IndexOf(setting);
+            if (input < 0) {
+                return;
+            }
+            // Compiled under the lock so concurrent updates can't publish an index built from older inputs
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _inputs[input] = value;
+            _known |= (1u << input);
+            _index = Compile(_inputs, _known);
+        }
+
+        void TrackPreferences::Invalidate()
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _known = 0;
+            _index = Compile(_inputs, 0);
+        }
+
+        bool TrackPreferences::IsComplete() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            return (_known == ((1u << INPUTS) - 1));
+        }
+
+        /**
+        * @brief Key of a language for the index: the ISO 639-1 code when there is one, whatever form
+        * it is given in, else the lower case ISO 639-2 code; 0 if it is neither.
+        */
+        /* static */ uint32_t TrackPreferences::LanguageKey(const string& language)
+        {
+            // Only the primary subtag of "en-US" or "en_US"
+            const size_t length = std::min(language.find_first_of("-_"), language.length());
+            char code[2];
+            if (LanguageCode::Language(language.c_str(), length, code)) {
+                return ((static_cast<uint32_t>(static_cast<unsigned char>(code[0])) << 8) | static_cast<unsigned char>(code[1]));
+            }
+            if ((length == 3) && LanguageCode::IsAlpha(language[0]) && LanguageCode::IsAlpha(language[1]) && LanguageCode::IsAlpha(language[2])) {
+                const char lower[3] = { LanguageCode::ToLower(language[0]), LanguageCode::ToLower(language[1]), LanguageCode::ToLower(language[2]) };
+                return (ALPHA3_KEY | LanguageCode::Table::Key(lower, 3));
+            }
+            return 0;
+        }
+
+        /* static */ void TrackPreferences::ParseLanguages(const string& languages, std::vector<uint32_t>& keys)
+        {
+            size_t begin = 0;
+            while (begin <= languages.length()) {
+                size_t end = languages.find(TRACK_LANGUAGE_SEPARATOR, begin);
+                if (string::npos == end) {
+                    end = languages.length();
+                }
+                const size_t first = languages.find_first_not_of(' ', begin);
+                const size_t last = languages.find_last_not_of(' ', end - 1);
+                if ((first < end) && (last != string::npos) && (last >= first)) {
+                    const uint32_t key = LanguageKey(languages.substr(first, last - first + 1));
+                    // The first mention ranks
+                    if ((key != 0) && (std::find(keys.begin(), keys.end(), key) == keys.end())) {
+                        keys.push_back(key);
+                    }
+                }
+                begin = end + 1;
+            }
+        }
+
+        /* static */ std::shared_ptr<const TrackPreferences::Index> TrackPreferences::Compile(const JsonValue inputs[], const uint8_t known)
+        {
+            std::shared_ptr<Index> index = std::make_shared<Index>();
+            if ((known & (1u << PREFERRED_AUDIO_LANGUAGES)) != 0) {
+                ParseLanguages(inputs[PREFERRED_AUDIO_LANGUAGES].String(), index->Audio);
+            }
+            if ((known & (1u << PREFERRED_CAPTIONS_LANGUAGES)) != 0) {
+                ParseLanguages(inputs[PREFERRED_CAPTIONS_LANGUAGES].String(), index->Captions);
+            }
+            if ((known & (1u << PREFERRED_CLOSED_CAPTION_SERVICE)) != 0) {
+                index->Service = inputs[PREFERRED_CLOSED_CAPTION_SERVICE].String();
+            }
+            index->CaptionsEnabled = (((known & (1u << CAPTIONS)) != 0) && inputs[CAPTIONS].Boolean());
+            index->AudioDescription = (((known & (1u << AUDIO_DESCRIPTION)) != 0) && inputs[AUDIO_DESCRIPTION].Boolean());
+            return index;
+        }
+
+        TrackPreferences::Selection TrackPreferences::Select(const Track tracks[], const size_t count) const
+        {
+            std::shared_ptr<const Index> current;
+            {
+                Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+                current = _index;
+            }
+            const Index& index = *current;
+
+            Selection selection = { -1, -1 };
+            uint32_t audioScore = ~0u;
+            uint32_t captionsScore = ~0u;
+            for (size_t position = 0; position < count; position++) {
+                const Track& track = tracks[position];
+                if (Exchange::IUserPreferences::TRACK_CAPTIONS == track.type) {
+                    if (index.CaptionsEnabled) {
+                        const uint32_t score = Score(index.Captions, LanguageKey(track.language), (!index.Service.empty() && (track.service == index.Service)));
+                        if (score < captionsScore) {
+                            captionsScore = score;
+                            selection.Captions = static_cast<int32_t>(position);
+                        }
+                    }
+                } else {
+                    const uint32_t score = Score(index.Audio, LanguageKey(track.language), (track.audioDescription == index.AudioDescription));
+                    if (score < audioScore) {
+                        audioScore = score;
+                        selection.Audio = static_cast<int32_t>(position);
+                    }
+                }
+            }
+            return selection;
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
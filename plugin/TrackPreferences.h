@@ -0,0 +1,94 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include "SettingsCache.h"
+#include <memory>
+#include <vector>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief The track preferences of UserSettings compiled into a ranking index, so a player can
+        * pick its audio and caption tracks with one call per stream start.
+        *
+        * Built from preferredAudioLanguages and preferredCaptionsLanguages (comma separated, most
+        * preferred first), preferredClosedCaptionService, captions and audioDescription, and rebuilt
+        * whenever one of them changes. Languages are normalised once when the index is built, so
+        * "eng", "en", "EN" and "en-US" all rank the same; ISO 639-2 codes without an ISO 639-1
+        * equivalent are kept as they are.
+        *
+        * Audio tracks are ranked on language, then on matching the audioDescription setting; caption
+        * tracks on language, then on the preferred service. Ties go to the first track, and a track
+        * in no preferred language still beats no track. No caption track is chosen while captions
+        * are off.
+        *
+        * Select() holds a reference to the current index, so it takes no lock while ranking and a
+        * rebuild never waits for it.
+        */
+        class TrackPreferences {
+        public:
+            // As passed to IUserPreferences::SelectTracks, so the tracks are ranked without copying them again
+            using Track = Exchange::IUserPreferences::Track;
+
+            struct Selection {
+                int32_t Audio;              // index of the audio track, -1 for none
+                int32_t Captions;           // index of the caption track, -1 for none
+            };
+
+            TrackPreferences(const TrackPreferences&) = delete;
+            TrackPreferences& operator=(const TrackPreferences&) = delete;
+
+            TrackPreferences();
+            ~TrackPreferences() = default;
+
+            // The settings the index is built from
+            static const std::vector<SettingsCache::Setting>& Inputs();
+
+            // Rebuilds the index if setting is one of the inputs
+            void Update(const SettingsCache::Setting setting, const JsonValue& value);
+            // Forgets the inputs, e.g. when UserSettings goes away
+            void Invalidate();
+            // True once every input has a value; until then missing inputs count as off or empty
+            bool IsComplete() const;
+
+            Selection Select(const Track tracks[], const size_t count) const;
+
+        private:
+            struct Index;
+
+            static constexpr uint8_t INPUTS = 5;
+
+            static int8_t IndexOf(const SettingsCache::Setting setting);
+            static std::shared_ptr<const Index> Compile(const JsonValue inputs[], const uint8_t known);
+            static void ParseLanguages(const string& languages, std::vector<uint32_t>& keys);
+            static uint32_t LanguageKey(const string& language);
+
+        private:
+            JsonValue _inputs[INPUTS];
+            uint8_t _known;             // bit n set: _inputs[n] holds a value
+            std::shared_ptr<const Index> _index;
+            mutable Core::CriticalSection _lock;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -20,63 +20,51 @@
 #pragma once
 
 #include "Module.h"
-#include <interfaces/IUserSettings.h>
-#include <mutex>
+#include <interfaces/IConfiguration.h>
+#include <interfaces/IUserPreferences.h>
+#include <interfaces/json/JUserPreferences.h>
 
 namespace WPEFramework {
     namespace Plugin {
 
+        /**
+        * @brief Plugin shell: instantiates UserPreferencesImplementation (in process, in its own
+        * process or in a container, as set by the "root" configuration), exposes it over JSON-RPC
+        * and forwards its notifications as JSON-RPC events.
+        */
         class UserPreferences : public PluginHost::IPlugin, public PluginHost::JSONRPC {
         private:
 
             UserPreferences(const UserPreferences&) = delete;
             UserPreferences& operator=(const UserPreferences&) = delete;
 
-            class Notification : public Exchange::IUserSettings::INotification {
+            class Notification : public RPC::IRemoteConnection::INotification
+                               , public Exchange::IUserPreferences::INotification {
                 public:
                     explicit Notification(UserPreferences* parent) : _parent(parent) {}
                     ~Notification() override = default;
-    
-                    void OnPresentationLanguageChanged(const string& language) override;
-                    void OnAudioDescriptionChanged(const bool enabled) override;
-                    void OnPreferredAudioLanguagesChanged(const string& preferredLanguages) override;
-                    void OnCaptionsChanged(const bool enabled) override;
-                    void OnPreferredCaptionsLanguagesChanged(const string& preferredLanguages) override;
-                    void OnPreferredClosedCaptionServiceChanged(const string& service) override;
-                    void OnPinControlChanged(const bool pinControl) override;
-                    void OnViewingRestrictionsChanged(const string& viewingRestrictions) override;
-                    void OnViewingRestrictionsWindowChanged(const string& viewingRestrictionsWindow) override;
-                    void OnLiveWatershedChanged(const bool liveWatershed) override;
-                    void OnPlaybackWatershedChanged(const bool playbackWatershed) override;
-                    void OnBlockNotRatedContentChanged(const bool blockNotRatedContent) override;
-                    void OnPinOnPurchaseChanged(const bool pinOnPurchase) override;
-                    void OnHighContrastChanged(const bool enabled) override;
-                    void OnVoiceGuidanceChanged(const bool enabled) override;
-                    void OnVoiceGuidanceRateChanged(const double rate) override;
-                    void OnVoiceGuidanceHintsChanged(const bool hints) override;
-    
+
+                    void Activated(RPC::IRemoteConnection* connection) override;
+                    void Deactivated(RPC::IRemoteConnection* connection) override;
+
+                    void OnUILanguageChanged(const string& ui_language) override;
+
                 private:
                     UserPreferences* _parent;
-    
+
                     BEGIN_INTERFACE_MAP(Notification)
-                    INTERFACE_ENTRY(Exchange::IUserSettings::INotification)
+                    INTERFACE_ENTRY(Exchange::IUserPreferences::INotification)
+                    INTERFACE_ENTRY(RPC::IRemoteConnection::INotification)
                     END_INTERFACE_MAP
             };
 
-
             //Begin methods
-            uint32_t getUILanguage(const JsonObject& parameters, JsonObject& response);
-            uint32_t setUILanguage(const JsonObject& parameters, JsonObject& response);
-
-            private:
-            bool ConvertToUserSettingsFormat(const string& uiLanguage, string& presentationLanguage);
-            bool ConvertToUserPrefsFormat(const string& presentationLanguage, string& uiLanguage);
-            bool PerformMigration(Exchange::IUserSettings& userSettings);
+#ifdef USERPREFERENCES_METRICS
+            uint32_t getMetrics(const JsonObject& parameters, JsonObject& response);
+            uint32_t resetMetrics(const JsonObject& parameters, JsonObject& response);
+#endif
             //End methods
 
-            //Begin events
-            //End events
-
         public:
             UserPreferences();
             virtual ~UserPreferences();
@@ -87,19 +75,16 @@ namespace WPEFramework {
             BEGIN_INTERFACE_MAP(UserPreferences)
             INTERFACE_ENTRY(PluginHost::IPlugin)
             INTERFACE_ENTRY(PluginHost::IDispatcher)
+            INTERFACE_AGGREGATE(Exchange::IUserPreferences, _userPreferences)
             END_INTERFACE_MAP
 
         private:
-            void OnPresentationLanguageChanged(const string& language);
+            void Deactivated(RPC::IRemoteConnection* connection);
+
             PluginHost::IShell* _service;
+            uint32_t _connectionId;
+            Exchange::IUserPreferences* _userPreferences;
             Core::Sink<Notification> _notification;
-            bool _isMigrationDone;
-            string _lastUILanguage;
-            mutable Core::CriticalSection _adminLock;
-    
-        public:
-            static UserPreferences* _instance;
-
         };
     } // namespace Plugin
 } // namespace WPEFramework
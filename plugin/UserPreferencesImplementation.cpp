@@ -0,0 +1,1234 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "UserPreferencesImplementation.h"
+#include "UtilsLogging.h"
+#include "LanguageCode.h"
+#include <algorithm>
+#include <ctime>
+
+
+#define SETTINGS_FILE_KEY               "ui_language"
+#define SETTINGS_FILE_GROUP              "General"
+
+#define USERSETTINGS_CALLSIGN           "org.rdk.UserSettings"
+
+#define MIGRATION_MAX_ATTEMPTS          3
+#define MIGRATION_RETRY_INTERVAL_MS     1000
+#define MIGRATION_WAIT_TIMEOUT_MS       3000   // How long a request waits for the migration thread
+
+#define EVENT_ONUILANGUAGECHANGED       "onUILanguageChanged"
+#define EVENT_COALESCE_MS               100    // Changes within this window result in a single event
+
+#define FILE_WATCH_DEBOUNCE_MS          200    // Quiet period after an external file edit before it is read
+
+using namespace std;
+
+namespace WPEFramework {
+
+    ENUM_CONVERSION_BEGIN(Plugin::PreferenceStore::FsyncPolicy)
+        { Plugin::PreferenceStore::FsyncPolicy::NONE, _TXT("none") },
+        { Plugin::PreferenceStore::FsyncPolicy::DATA, _TXT("data") },
+        { Plugin::PreferenceStore::FsyncPolicy::FULL, _TXT("full") },
+    ENUM_CONVERSION_END(Plugin::PreferenceStore::FsyncPolicy)
+
+    namespace Plugin {
+
+        SERVICE_REGISTRATION(UserPreferencesImplementation, 1, 0, 0);
+
+        UserPreferencesImplementation* UserPreferencesImplementation::_instance = nullptr;
+
+        UserPreferencesImplementation::UserPreferencesImplementation()
+            : _service(nullptr)
+            , _notification(this)
+            , _userSettings(USERSETTINGS_CALLSIGN)
+            , _state()
+            , _migrationAttempts(0)
+            , _migrationCompleted(false, true)
+            , _lastUILanguage("")
+            , _store(SETTINGS_FILE_GROUP)
+            , _pendingUILanguage("")
+            , _migrationThread(*this)
+            , _unsavedUILanguage("")
+            , _persistDelayMs(0)
+            , _persistLock()
+            , _persistJob(*this)
+            , _metrics()
+            , _changedUILanguage("")
+            , _notifiedUILanguage("")
+            , _eventLock()
+            , _eventJob(*this)
+            , _settings()
+            , _restrictions()
+            , _tracks()
+            , _snapshot()
+            , _watcher()
+            , _reconcileJob(*this)
+            , _changedSettings()
+            , _changedMask(0)
+            , _notificationLock()
+            , _notificationJob(*this)
+            , _clients()
+            ,_adminLock()
+            , _pendingLock()
+        {
+            LOGINFO("ctor");
+            UserPreferencesImplementation::_instance = this;
+        }
+
+        UserPreferencesImplementation::~UserPreferencesImplementation()
+        {
+            LOGINFO("dtor");
+            // Coverity Fix: ID 540 - Dereference before null check: Check _service before dereferencing
+            if (_service != nullptr) {
+                _service->Unregister(&_notification);
+            }
+            _migrationThread.Revoke();
+            // Stopped first, the reconcile job would otherwise be rescheduled
+            _watcher.Stop();
+            _reconcileJob.Revoke();
+            // Unregisters the UserSettings notification and releases the held interface,
+            // so no notification can reschedule the jobs below once they are revoked
+            _userSettings.Reset();
+            // Revoked before the jobs it schedules
+            _notificationJob.Revoke();
+            _eventJob.Revoke();
+            // Don't lose a change that is still waiting for its quiet period to expire
+            _persistJob.Revoke();
+            FlushUILanguage();
+            _snapshot.Close();
+            _adminLock.Lock();
+            for (Exchange::IUserPreferences::INotification* client : _clients) {
+                client->Release();
+            }
+            _clients.clear();
+            if (nullptr != _service) {
+                _service->Release();
+                _service = nullptr;
+            }
+            _adminLock.Unlock();
+
+            UserPreferencesImplementation::_instance = nullptr;
+        }
+
+        /**
+        * @brief Converts a UI language string used in the UserPreferences plugin
+        * to the presentation language format expected by the UserSettings plugin.
+        * @param[in]  uiLanguage            Input string in UserPreferences format (e.g., "US_en").
+        *                                    Expected format: "US_en", where:
+        *                                    - The first two characters are an ISO 3166-1 alpha-2 country code.
+        *                                    - The last two characters are an ISO 639-1 language code.
+        *                                    - The separator must be an underscore '_'.
+        *                                    - The total length must be exactly 5 characters.
+        *                                    Codes are matched case insensitive and normalized ("us_EN" gives "en-US").
+        *
+        * @param[out] presentationLanguage  Output string in usersettings format (e.g., "en-US").
+        *                                    If the input is invalid, the output string remains unchanged.
+        *
+        * @return True if the conversion was successful and both codes are valid.
+        *         False if the input format is incorrect or a code is unknown (e.g., "12_!!").
+        */
+
+        bool UserPreferencesImplementation::ConvertToUserSettingsFormat(const string& uiLanguage, string& presentationLanguage) {
+            char converted[LanguageCode::BUFFER_SIZE];
+            if (LanguageCode::ToPresentation(uiLanguage.c_str(), uiLanguage.length(), converted)) {
+                presentationLanguage.assign(converted, LanguageCode::CODE_LENGTH);
+                return true;
+            }
+            LOGERR("Invalid UI language format: %s", uiLanguage.c_str());
+            return false;
+        }
+
+        /**
+        * @brief Converts a presentation language format string used in the UserSettings plugin
+        * to a UI language format string used in the UserPreferences plugin.
+        *
+        * @param[in]  presentationLanguage  Input string in usersettings format (e.g., "en-US").
+        *                                    Accepted forms:
+        *                                    - "en-US": ISO 639-1 language, hyphen, ISO 3166-1 alpha-2 country.
+        *                                    - "eng-US": ISO 639-2 language, mapped to its ISO 639-1 code.
+        *                                    - "zh-Hans-CN": with a script subtag, which is dropped.
+        *
+        * @param[out] uiLanguage            Output string in Userpreferences format (e.g., "US_en").
+        *                                    If the input is invalid, the output string remains unchanged.
+        *
+        * @return True  - If the input string is a valid presentation language and was converted.
+        *         False - If the input string is malformed or a code is unknown. In this case,
+        *                 no conversion is performed.
+        */
+
+        bool UserPreferencesImplementation::ConvertToUserPrefsFormat(const string& presentationLanguage, string& uiLanguage) {
+            char converted[LanguageCode::BUFFER_SIZE];
+            if (LanguageCode::ToUI(presentationLanguage.c_str(), presentationLanguage.length(), converted)) {
+                uiLanguage.assign(converted, LanguageCode::CODE_LENGTH);
+                return true;
+            }
+            LOGERR("Invalid presentation language format: %s", presentationLanguage.c_str());
+            return false;
+        }
+
+        /**
+        * @brief Validates a UI language and brings it into its canonical form ("us_EN" gives "US_en"),
+        * which is the form cached, queued and compared against.
+        * @param[in]  uiLanguage            UI language as given by a caller or the legacy file.
+        * @param[out] normalized            The canonical UI language.
+        * @param[out] presentationLanguage  The same language in UserSettings format (e.g., "en-US").
+        * @return False if uiLanguage is not a valid UI language.
+        */
+        bool UserPreferencesImplementation::NormalizeUILanguage(const string& uiLanguage, string& normalized, string& presentationLanguage) {
+            return (ConvertToUserSettingsFormat(uiLanguage, presentationLanguage)
+                && ConvertToUserPrefsFormat(presentationLanguage, normalized));
+        }
+
+        // New function to handle migration logic
+        bool UserPreferencesImplementation::PerformMigration(Exchange::IUserSettings& userSettings) {
+            
+
+            Exchange::IUserSettingsInspector* userSettingsInspector = nullptr;
+            {
+                Metrics::Scope metrics(_metrics, Metrics::QUERY_INTERFACE);
+                userSettingsInspector = _service->QueryInterfaceByCallsign<Exchange::IUserSettingsInspector>(USERSETTINGS_CALLSIGN);
+                if (nullptr == userSettingsInspector) {
+                    metrics.Failed();
+                }
+            }
+            if (nullptr == userSettingsInspector) {
+                LOGERR("Failed to get UserSettingsInspector interface for migration");
+                return false;
+            }
+        
+            bool requiresMigration = false;
+            uint32_t status = userSettingsInspector->GetMigrationState(Exchange::IUserSettingsInspector::SettingsKey::PRESENTATION_LANGUAGE, requiresMigration);
+            if (Core::ERROR_NONE != status) {
+                LOGERR("Failed to get migration state: %u", status);
+                userSettingsInspector->Release();
+                return false;
+            }
+        
+            if (requiresMigration) {
+                LOGINFO("Migration is required for presentation language");
+                
+                string uiLanguage;
+                uint32_t result = _store.Get(SETTINGS_FILE_KEY, uiLanguage);
+
+                // Case 1: If migration is needed and file exists,
+                //read UILanguage from file, translate to PresentationLanguage and set it in UserSettings
+                if ((Core::ERROR_NONE == result) || (Core::ERROR_UNKNOWN_KEY == result)) {
+                    // Read existing UI language from file and update UserSettings
+                    if (Core::ERROR_NONE == result) {
+                        // Convert UI language to presentation language format
+                        string presentationLanguage;
+                        if (ConvertToUserSettingsFormat(uiLanguage, presentationLanguage)) {
+                            status = SetPresentationLanguage(userSettings, presentationLanguage);
+                            if (status != Core::ERROR_NONE) {
+                                LOGERR("Failed to set presentation language: %u", status);
+                                userSettingsInspector->Release();
+                                return false;
+                            }
+                            else{
+                    
+                                LOGINFO("Successfully set the presentation language for migration: %s", presentationLanguage.c_str());
+                            }
+                        } else {
+                            /*File is present but our expected setting is not there!
+                            Nothing to set to usersettings, but setting MigrationDone, So that future get/set will be aligned to user settings values and the "junk" value in the file will be replaced.*/
+                
+                            LOGERR("Invalid UI language format in file: %s", uiLanguage.c_str());
+                        }
+                    } else {
+                        /*File is present but our expected setting is not there!
+                         Nothing to set to usersettings, but setting MigrationDone, So that future get/set will be aligned to user settings values and the "junk" value in the file will be replaced.*/
+               
+                            LOGERR("Failed to read UI language from file '%s'", _store.Path().c_str());
+                    }
+                    // Case 2: If migration is needed and file does NOT exist,
+                    //get PresentationLanguage from UserSettings, translate to UILanguage and create the file with it
+                } else if (Core::ERROR_UNAVAILABLE == result) {
+                    LOGINFO("migration is required but file %s is missing", _store.Path().c_str());
+                    string presentationLanguage;
+                    status = GetPresentationLanguage(userSettings, presentationLanguage);
+                    if (status == Core::ERROR_NONE) {
+                        if (ConvertToUserPrefsFormat(presentationLanguage, uiLanguage)) {
+                            if (Core::ERROR_NONE != SaveUILanguage(uiLanguage)) {
+                                LOGERR("Failed to save UI language '%s' to file '%s'", uiLanguage.c_str(), _store.Path().c_str());
+                            }
+                            else{
+                                LOGINFO("successfully saved the language in to the file");
+                            }
+                        } else {
+                            LOGERR("Invalid presentation language: %s", presentationLanguage.c_str());
+                        }
+                    } else {
+                        LOGERR("Failed to get presentation language: %u", status);
+                    }
+                } else {
+                    LOGERR("Failed to load file '%s'", _store.Path().c_str());
+                }
+            } else {
+                LOGINFO("No migration required for presentation language");
+
+            /* Case 3: Migration not needed
+            Read PresentationLanguage from UserSettings, convert it to UILanguage format,and update the file to handle edge cases where values in UserPreferences and UserSettings may differ, ensuring both remain consistent. */
+                string presentationLanguage;
+                status = GetPresentationLanguage(userSettings, presentationLanguage);
+                if (Core::ERROR_NONE == status) {
+                    string uiLanguage;
+                    // Skipped by the store when the file already holds this value, which is the usual boot case
+                    if (ConvertToUserPrefsFormat(presentationLanguage, uiLanguage)) {
+                        if (Core::ERROR_NONE != SaveUILanguage(uiLanguage)) {
+                            LOGERR("Failed to save file '%s'", _store.Path().c_str());
+                        }
+                    } else {
+                        LOGERR("Invalid presentation language: %s", presentationLanguage.c_str());
+                    }
+                } else {
+                    LOGERR("Failed to get presentation language: %u", status);
+                }
+            }
+
+            userSettingsInspector->Release();
+            LOGINFO("Migration completed successfully");
+            return true;
+        }
+        
+        /**
+        * @brief Called by the UserPreferences plugin right after instantiation, in or out of process.
+        * @param[in] service  The plugin's shell; its configuration holds persistdelay, path and fsync.
+        */
+        uint32_t UserPreferencesImplementation::Configure(PluginHost::IShell* service) {
+            LOGINFO("Configuring UserPreferences implementation");
+            ASSERT(service != nullptr);
+            ASSERT(_service == nullptr);
+
+            _service = service;
+            _service->AddRef();
+
+            Config config;
+            config.FromString(_service->ConfigLine());
+            _persistDelayMs = config.PersistDelay.Value();
+            _store.Configure(config.Path.Value(), config.Fsync.Value());
+            // Legacy scripts still edit the file directly; pick their changes up as they happen
+            if (Core::ERROR_NONE != _watcher.Start(config.Path.Value(), [this]() {
+                    _reconcileJob.Reschedule(Core::Time::Now().Add(FILE_WATCH_DEBOUNCE_MS));
+                })) {
+                LOGWARN("External edits of '%s' are not watched", config.Path.Value().c_str());
+            }
+            // Optional: without it native readers simply find no snapshot
+            if (!config.Snapshot.Value().empty()) {
+                _snapshot.Open(config.Snapshot.Value());
+            }
+
+            /* The UserSettings interface is resolved once and kept until UserSettings deactivates
+            * or this implementation is destroyed; the notification is registered once per resolved interface. */
+            _userSettings.builder().withIShell(_service);
+            _userSettings.OnAcquired([this](Exchange::IUserSettings& userSettings) {
+                userSettings.Register(&_notification);
+                LOGINFO("Successfully registered for UserSettings notifications");
+            });
+            _userSettings.OnReleasing([this](Exchange::IUserSettings& userSettings) {
+                userSettings.Unregister(&_notification);
+            });
+
+            // Assumed up until a lookup fails or UserSettings deactivates; see RequestUserSettings()
+            _state.SetUserSettingsAvailable(true);
+
+            /* Don't wait for UserSettings here. Thunder reports Activated() for every plugin that is
+            * already up when we register, and again whenever UserSettings (re)activates later on,
+            * so migration and registration run from OnUserSettingsActivated() on the migration thread. */
+            _service->Register(&_notification);
+
+            return Core::ERROR_NONE;
+        }
+
+        void UserPreferencesImplementation::Notification::OnPresentationLanguageChanged(const string& language) {
+            /* UserSettings notifies its subscribers one after the other, so anything done here delays
+            * all of them. Only queue the value; the conversion, caches, file write and event run on
+            * the NotificationJob. */
+            _parent->QueueSettingChange(SettingsCache::PRESENTATION_LANGUAGE, JsonValue(language));
+        }
+
+        /**
+        * @brief Records a value reported by a UserSettings notification and schedules the NotificationJob.
+        * A value not handled yet is overwritten, so a burst of changes to one setting is handled once.
+        * @param[in] setting  The setting that changed.
+        * @param[in] value    Its new value.
+        */
+        void UserPreferencesImplementation::QueueSettingChange(const SettingsCache::Setting setting, const JsonValue& value) {
+            _notificationLock.Lock();
+            _changedSettings[setting] = value;
+            _changedMask |= (1u << setting);
+            _notificationLock.Unlock();
+            // No-op while the job is already queued
+            _notificationJob.Submit();
+        }
+
+        /**
+        * @brief Forgets the queued changes, as they were reported by a UserSettings instance that is gone.
+        */
+        void UserPreferencesImplementation::DropSettingChanges() {
+            _notificationLock.Lock();
+            _changedMask = 0;
+            _notificationLock.Unlock();
+        }
+
+        /**
+        * @brief Handles the changes queued since the last run. Runs on the NotificationJob, one
+        * run at a time, so changes are handled in the order UserSettings reported them per setting.
+        */
+        void UserPreferencesImplementation::DispatchSettingChanges() {
+            JsonValue changed[SettingsCache::SETTINGS];
+            uint32_t mask;
+            _notificationLock.Lock();
+            mask = _changedMask;
+            _changedMask = 0;
+            for (uint8_t setting = 0; setting < SettingsCache::SETTINGS; setting++) {
+                if ((mask & (1u << setting)) != 0) {
+                    changed[setting] = _changedSettings[setting];
+                }
+            }
+            _notificationLock.Unlock();
+
+            for (uint8_t setting = 0; setting < SettingsCache::SETTINGS; setting++) {
+                if ((mask & (1u << setting)) == 0) {
+                    continue;
+                }
+                if (SettingsCache::PRESENTATION_LANGUAGE == setting) {
+                    OnPresentationLanguageChanged(changed[setting].String());
+                } else {
+                    OnSettingChanged(static_cast<SettingsCache::Setting>(setting), changed[setting]);
+                }
+            }
+        }
+
+        void UserPreferencesImplementation::OnPresentationLanguageChanged(const string& language) {
+            Metrics::Scope metrics(_metrics, Metrics::NOTIFICATION);
+            LOGINFO("Presentation language changed to: %s", language.c_str());
+            string uiLanguage;
+            UpdateSetting(SettingsCache::PRESENTATION_LANGUAGE, JsonValue(language));
+            if (ConvertToUserPrefsFormat(language, uiLanguage)) {
+                UpdateCachedUILanguage(uiLanguage);
+                PersistUILanguage(uiLanguage);
+
+                // Like the file write, the event waits for a quiet period so a burst of changes is sent once
+                _eventLock.Lock();
+                _changedUILanguage = uiLanguage;
+                _eventLock.Unlock();
+                _eventJob.Reschedule(Core::Time::Now().Add(EVENT_COALESCE_MS));
+            } else {
+                metrics.Failed();
+                LOGERR("Invalid presentation language format: %s", language.c_str());
+            }
+        }
+
+        /**
+        * @brief Queues the UI language for the write-behind PersistJob. Changes arriving within the
+        * configured quiet period (persistdelay) restart it, so a burst results in a single file write.
+        * @param[in] uiLanguage  UI language in UserPreferences format (e.g., "US_en").
+        */
+        void UserPreferencesImplementation::PersistUILanguage(const string& uiLanguage) {
+            _persistLock.Lock();
+            _unsavedUILanguage = uiLanguage;
+            _persistLock.Unlock();
+            _persistJob.Reschedule(Core::Time::Now().Add(_persistDelayMs));
+        }
+
+        /**
+        * @brief Writes the last queued UI language to the file. Runs on the PersistJob, and
+        * synchronously from Deinitialize() to flush a change still in its quiet period.
+        * It is the only user of _lastUILanguage, and never runs concurrently with itself.
+        */
+        void UserPreferencesImplementation::FlushUILanguage() {
+            string uiLanguage;
+            _persistLock.Lock();
+            uiLanguage.swap(_unsavedUILanguage);
+            _persistLock.Unlock();
+
+            if (uiLanguage.empty()) {
+                return;
+            }
+            if (uiLanguage == _lastUILanguage) {
+                LOGINFO("UI language '%s' is already set, no file update needed", uiLanguage.c_str());
+                return;
+            }
+
+            if (Core::ERROR_NONE == SaveUILanguage(uiLanguage)) {
+                // Coverity Fix: ID 67 - COPY_INSTEAD_OF_MOVE: Use std::move for assignment
+                _lastUILanguage = std::move(uiLanguage);
+            } else {
+                LOGERR("Error saving file '%s'", _store.Path().c_str());
+            }
+        }
+
+        /**
+        * @brief Pushes a UI language written to the file by someone else into UserSettings. Runs on the
+        * ReconcileJob once FILE_WATCH_DEBOUNCE_MS passed without further writes; the store's own writes,
+        * and edits that match the cached UI language, are ignored.
+        */
+        void UserPreferencesImplementation::ReconcileFile() {
+            string uiLanguage;
+            if (!_store.GetExternalChange(SETTINGS_FILE_KEY, uiLanguage)) {
+                return;
+            }
+
+            // The file may hold any casing; the cache holds the canonical form
+            string normalized;
+            string presentationLanguage;
+            string cachedUILanguage;
+            if (NormalizeUILanguage(uiLanguage, normalized, presentationLanguage)
+                && _state.Get().UILanguage(cachedUILanguage) && (cachedUILanguage == normalized)) {
+                return;
+            }
+
+            LOGINFO("'%s' changed externally, applying UI language '%s'", _store.Path().c_str(), uiLanguage.c_str());
+            // Validates the value, and queues it while UserSettings is not available
+            if (Core::ERROR_NONE != WriteUILanguage(uiLanguage)) {
+                LOGERR("Failed to apply UI language '%s' from '%s'", uiLanguage.c_str(), _store.Path().c_str());
+            }
+        }
+
+        void UserPreferencesImplementation::OnUserSettingsAvailable() {
+            LOGINFO("UserSettings activated, scheduling setup");
+            // From here on requests look the interface up again
+            _state.SetUserSettingsAvailable(true);
+            MigrationState expected = MigrationState::FAILED;
+            if (_state.ExchangeMigration(expected, MigrationState::PENDING)) {
+                // Give a migration that ran out of attempts a new round with the fresh instance
+                _migrationAttempts = 0;
+                _migrationCompleted.ResetEvent();
+            }
+            _migrationThread.Submit();
+        }
+
+        /**
+        * @brief Run on the MigrationThread whenever UserSettings becomes available. Drives the migration
+        * state machine (PENDING -> RUNNING -> DONE, or back to PENDING for a delayed retry, or FAILED after
+        * MIGRATION_MAX_ATTEMPTS), then applies a queued setUILanguage value and primes the read cache.
+        * Requests never run the migration themselves; they wait on _migrationCompleted instead, a manual
+        * reset event set after every attempt, so it releases all of them at once, and a failed attempt
+        * releases them right away.
+        * Besides the thread being the only runner, the PENDING -> RUNNING transition is claimed with a
+        * compare-exchange, so a migration can never run twice concurrently.
+        * @return The delay before the next attempt, Core::infinite if none is needed.
+        */
+        uint32_t UserPreferencesImplementation::OnUserSettingsActivated() {
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings = AcquireUserSettings();
+            if (!userSettings) {
+                LOGERR("UserSettings reported active but its interface is not available");
+                // Nothing to wait for; the next activation submits a new attempt
+                _migrationCompleted.SetEvent();
+                return Core::infinite;
+            }
+
+            // Before the attempt is claimed, so a request that sees it RUNNING never finds the
+            // event still set by the previous one; every path below sets it again
+            _migrationCompleted.ResetEvent();
+            MigrationState state = MigrationState::PENDING;
+            if (_state.ExchangeMigration(state, MigrationState::RUNNING)) {
+                bool migrated = PerformMigration(*userSettings);
+
+                if (migrated) {
+                    state = MigrationState::DONE;
+                } else if (++_migrationAttempts < MIGRATION_MAX_ATTEMPTS) {
+                    state = MigrationState::PENDING;
+                } else {
+                    state = MigrationState::FAILED;
+                }
+                _state.SetMigration(state);
+
+                if (MigrationState::PENDING == state) {
+                    LOGWARN("Migration failed, retrying in %d ms (attempt %u/%d)", MIGRATION_RETRY_INTERVAL_MS, _migrationAttempts.load(), MIGRATION_MAX_ATTEMPTS);
+                    _migrationCompleted.SetEvent();
+                    return MIGRATION_RETRY_INTERVAL_MS;
+                }
+                LOGINFO("Migration %s", (MigrationState::DONE == state) ? "completed" : "failed, giving up");
+            }
+
+            if (MigrationState::DONE != state) {
+                _migrationCompleted.SetEvent();
+                return Core::infinite;
+            }
+
+            // Apply a setUILanguage request that arrived before UserSettings was available
+            string pendingUILanguage;
+            _pendingLock.Lock();
+            pendingUILanguage.swap(_pendingUILanguage);
+            _pendingLock.Unlock();
+
+            string presentationLanguage;
+            if (!pendingUILanguage.empty() && ConvertToUserSettingsFormat(pendingUILanguage, presentationLanguage)) {
+                uint32_t status = SetPresentationLanguage(*userSettings, presentationLanguage);
+                if (Core::ERROR_NONE != status) {
+                    LOGERR("Failed to apply queued presentation language '%s': %u", presentationLanguage.c_str(), status);
+                }
+            }
+
+            // Prime the read cache; from here on it is kept current by OnPresentationLanguageChanged
+            string uiLanguage;
+            if ((Core::ERROR_NONE == GetPresentationLanguage(*userSettings, presentationLanguage))
+                && ConvertToUserPrefsFormat(presentationLanguage, uiLanguage)) {
+                UpdateCachedUILanguage(uiLanguage);
+            }
+
+            _migrationCompleted.SetEvent();
+            return Core::infinite;
+        }
+
+        bool UserPreferencesImplementation::IsMigrationDone() const {
+            // Lock-free: once DONE the state only changes again after a plugin restart
+            return (MigrationState::DONE == _state.Get().Migration());
+        }
+
+        /**
+        * @brief Makes sure the migration thread runs and waits for its attempt to finish. The wait never
+        * depends on the WorkerPool, which the calling request may be occupying.
+        * @return True if the migration is done, false if the attempt failed, a retry is pending, or it did
+        * not finish within MIGRATION_WAIT_TIMEOUT_MS.
+        */
+        bool UserPreferencesImplementation::WaitForMigration() {
+            MigrationState state = _state.Get().Migration();
+
+            if ((MigrationState::PENDING == state) && (0 == _migrationAttempts)) {
+                // Nothing ran yet; once an attempt failed the thread retries on its own schedule
+                _migrationThread.Submit();
+            }
+            if ((MigrationState::DONE != state) && (MigrationState::FAILED != state)
+                && (Core::ERROR_NONE != _migrationCompleted.Lock(MIGRATION_WAIT_TIMEOUT_MS))) {
+                LOGERR("Timed out after %d ms waiting for migration", MIGRATION_WAIT_TIMEOUT_MS);
+                return false;
+            }
+            return IsMigrationDone();
+        }
+
+        void UserPreferencesImplementation::OnUserSettingsDeactivated() {
+            LOGINFO("UserSettings deactivated, dropping the held interface");
+            // UserSettings is already gone, so there is nothing left to unregister from
+            _userSettings.Invalidate();
+            _state.SetUserSettingsAvailable(false);
+            DropSettingChanges();
+            // Changes made while UserSettings is down would not be notified to us
+            InvalidateCachedUILanguage();
+            _settings.Invalidate();
+            _restrictions.Invalidate();
+            _tracks.Invalidate();
+            _snapshot.ClearSettings();
+        }
+
+        /**
+        * @brief Reads the UI language from the legacy settings file, used while UserSettings is not yet available.
+        * @param[out] uiLanguage  UI language in UserPreferences format (e.g., "US_en").
+        * @return True if the file holds a UI language, false otherwise.
+        */
+        bool UserPreferencesImplementation::ReadUILanguageFromFile(string& uiLanguage) const {
+            return (Core::ERROR_NONE == _store.Get(SETTINGS_FILE_KEY, uiLanguage));
+        }
+
+        /**
+        * @brief Publishes the UI language to the lock-free request state (_state) and to the shared
+        * memory snapshot for native readers.
+        * @param[in] uiLanguage  UI language in the canonical UserPreferences format (e.g., "US_en").
+        */
+        void UserPreferencesImplementation::UpdateCachedUILanguage(const string& uiLanguage) {
+            _state.SetUILanguage(uiLanguage);
+            _snapshot.SetUILanguage(uiLanguage);
+        }
+
+        void UserPreferencesImplementation::InvalidateCachedUILanguage() {
+            _state.ClearUILanguage();
+            _snapshot.ClearUILanguage();
+        }
+
+        void UserPreferencesImplementation::UpdateSetting(const SettingsCache::Setting setting, const JsonValue& value) {
+            _settings.Update(setting, value);
+            _restrictions.Update(setting, value);
+            _tracks.Update(setting, value);
+            _snapshot.Set(setting, value);
+        }
+
+        /**
+        * @brief Returns the UserSettings interface for a request. While UserSettings is down the request goes
+        * straight to its fallback, without a lookup (and its error log) per request. A failed lookup marks
+        * it down; only the activation notification (OnUserSettingsAvailable) makes it available again.
+        */
+        PluginInterfaceRef<Exchange::IUserSettings> UserPreferencesImplementation::RequestUserSettings() {
+            const StateSnapshot::View state = _state.Get();
+            if (!state.IsUserSettingsAvailable()) {
+                return PluginInterfaceRef<Exchange::IUserSettings>();
+            }
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings = AcquireUserSettings();
+            if (!userSettings) {
+                // Unless an activation was reported since the state was read
+                _state.ClearUserSettingsAvailable(state);
+            }
+            return userSettings;
+        }
+
+        /**
+        * @brief Returns the held UserSettings interface, resolving it first if there is none.
+        * Only the resolution is recorded as a QueryInterfaceByCallsign sample.
+        */
+        PluginInterfaceRef<Exchange::IUserSettings> UserPreferencesImplementation::AcquireUserSettings() {
+            if (_userSettings.IsValid()) {
+                return _userSettings.Acquire();
+            }
+            Metrics::Scope metrics(_metrics, Metrics::QUERY_INTERFACE);
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings = _userSettings.Acquire();
+            if (!userSettings) {
+                metrics.Failed();
+            }
+            return userSettings;
+        }
+
+        uint32_t UserPreferencesImplementation::GetPresentationLanguage(Exchange::IUserSettings& userSettings, string& presentationLanguage) {
+            Metrics::Scope metrics(_metrics, Metrics::GET_PRESENTATION_LANGUAGE);
+            const uint32_t status = userSettings.GetPresentationLanguage(presentationLanguage);
+            metrics.Result(status);
+            return status;
+        }
+
+        uint32_t UserPreferencesImplementation::SetPresentationLanguage(Exchange::IUserSettings& userSettings, const string& presentationLanguage) {
+            Metrics::Scope metrics(_metrics, Metrics::SET_PRESENTATION_LANGUAGE);
+            const uint32_t status = userSettings.SetPresentationLanguage(presentationLanguage);
+            metrics.Result(status);
+            return status;
+        }
+
+        uint32_t UserPreferencesImplementation::SaveUILanguage(const string& uiLanguage) {
+            Metrics::Scope metrics(_metrics, Metrics::FILE_SAVE);
+            const uint32_t status = _store.Set(SETTINGS_FILE_KEY, uiLanguage);
+            metrics.Result(status);
+            return status;
+        }
+
+        void UserPreferencesImplementation::Notification::Activated(const string& callsign, PluginHost::IShell* plugin) {
+            if (callsign == USERSETTINGS_CALLSIGN) {
+                _parent->OnUserSettingsAvailable();
+            }
+        }
+
+        void UserPreferencesImplementation::Notification::Deactivated(const string& callsign, PluginHost::IShell* plugin) {
+            if (callsign == USERSETTINGS_CALLSIGN) {
+                _parent->OnUserSettingsDeactivated();
+            }
+        }
+
+        void UserPreferencesImplementation::Notification::Unavailable(const string& callsign, PluginHost::IShell* plugin) {
+
+        }
+
+        void UserPreferencesImplementation::Notification::OnAudioDescriptionChanged(const bool enabled)  {
+            _parent->QueueSettingChange(SettingsCache::AUDIO_DESCRIPTION, JsonValue(enabled));
+        }
+        void UserPreferencesImplementation::Notification::OnPreferredAudioLanguagesChanged(const string& preferredLanguages)  {
+            _parent->QueueSettingChange(SettingsCache::PREFERRED_AUDIO_LANGUAGES, JsonValue(preferredLanguages));
+        }
+        void UserPreferencesImplementation::Notification::OnCaptionsChanged(const bool enabled)  {
+            _parent->QueueSettingChange(SettingsCache::CAPTIONS, JsonValue(enabled));
+        }
+        void UserPreferencesImplementation::Notification::OnPreferredCaptionsLanguagesChanged(const string& preferredLanguages)  {
+            _parent->QueueSettingChange(SettingsCache::PREFERRED_CAPTIONS_LANGUAGES, JsonValue(preferredLanguages));
+        }
+       
+        void UserPreferencesImplementation::Notification::OnPreferredClosedCaptionServiceChanged(const string& service)  {
+            _parent->QueueSettingChange(SettingsCache::PREFERRED_CLOSED_CAPTION_SERVICE, JsonValue(service));
+        }
+        
+        void UserPreferencesImplementation::Notification::OnPinControlChanged(const bool pinControl)  {
+            _parent->QueueSettingChange(SettingsCache::PIN_CONTROL, JsonValue(pinControl));
+        }
+       
+        void UserPreferencesImplementation::Notification::OnViewingRestrictionsChanged(const string& viewingRestrictions)  {
+            _parent->QueueSettingChange(SettingsCache::VIEWING_RESTRICTIONS, JsonValue(viewingRestrictions));
+        }
+       
+        void UserPreferencesImplementation::Notification::OnViewingRestrictionsWindowChanged(const string& viewingRestrictionsWindow)  {
+            _parent->QueueSettingChange(SettingsCache::VIEWING_RESTRICTIONS_WINDOW, JsonValue(viewingRestrictionsWindow));
+        }
+      
+        void UserPreferencesImplementation::Notification::OnLiveWatershedChanged(const bool liveWatershed)  {
+            _parent->QueueSettingChange(SettingsCache::LIVE_WATERSHED, JsonValue(liveWatershed));
+        }
+       
+        void UserPreferencesImplementation::Notification::OnPlaybackWatershedChanged(const bool playbackWatershed)  {
+            _parent->QueueSettingChange(SettingsCache::PLAYBACK_WATERSHED, JsonValue(playbackWatershed));
+        }
+       
+        void UserPreferencesImplementation::Notification::OnBlockNotRatedContentChanged(const bool blockNotRatedContent)  {
+            _parent->QueueSettingChange(SettingsCache::BLOCK_NOT_RATED_CONTENT, JsonValue(blockNotRatedContent));
+        }
+      
+        void UserPreferencesImplementation::Notification::OnPinOnPurchaseChanged(const bool pinOnPurchase)  {
+            _parent->QueueSettingChange(SettingsCache::PIN_ON_PURCHASE, JsonValue(pinOnPurchase));
+        }
+        
+        void UserPreferencesImplementation::Notification::OnHighContrastChanged(const bool enabled)  {
+            _parent->QueueSettingChange(SettingsCache::HIGH_CONTRAST, JsonValue(enabled));
+        }
+        void UserPreferencesImplementation::Notification::OnVoiceGuidanceChanged(const bool enabled)  {
+            _parent->QueueSettingChange(SettingsCache::VOICE_GUIDANCE, JsonValue(enabled));
+        }
+        void UserPreferencesImplementation::Notification::OnVoiceGuidanceRateChanged(const double rate)  {
+            _parent->QueueSettingChange(SettingsCache::VOICE_GUIDANCE_RATE, JsonValue(rate));
+        }
+        
+        void UserPreferencesImplementation::Notification::OnVoiceGuidanceHintsChanged(const bool hints)  {
+            _parent->QueueSettingChange(SettingsCache::VOICE_GUIDANCE_HINTS, JsonValue(hints));
+        }
+
+        //Begin methods
+        Core::hresult UserPreferencesImplementation::Register(Exchange::IUserPreferences::INotification* notification) {
+            ASSERT(nullptr != notification);
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+            if (std::find(_clients.begin(), _clients.end(), notification) == _clients.end()) {
+                _clients.push_back(notification);
+                notification->AddRef();
+            }
+            return Core::ERROR_NONE;
+        }
+
+        Core::hresult UserPreferencesImplementation::Unregister(Exchange::IUserPreferences::INotification* notification) {
+            ASSERT(nullptr != notification);
+            Core::SafeSyncType<Core::CriticalSection> lock(_adminLock);
+            std::list<Exchange::IUserPreferences::INotification*>::iterator index = std::find(_clients.begin(), _clients.end(), notification);
+            if (index == _clients.end()) {
+                return Core::ERROR_UNKNOWN_KEY;
+            }
+            (*index)->Release();
+            _clients.erase(index);
+            return Core::ERROR_NONE;
+        }
+
+        Core::hresult UserPreferencesImplementation::GetUILanguage(string& ui_language, bool& success) {
+            Metrics::Scope metrics(_metrics, Metrics::GET_UI_LANGUAGE);
+            const uint32_t result = ReadUILanguage(ui_language);
+            metrics.Result(result);
+            success = (Core::ERROR_NONE == result);
+            return result;
+        }
+
+        Core::hresult UserPreferencesImplementation::SetUILanguage(const string& ui_language, bool& success) {
+            Metrics::Scope metrics(_metrics, Metrics::SET_UI_LANGUAGE);
+            LOGINFO("ui_language: %s", ui_language.c_str());
+            const uint32_t result = WriteUILanguage(ui_language);
+            metrics.Result(result);
+            success = (Core::ERROR_NONE == result);
+            return result;
+        }
+
+        Core::hresult UserPreferencesImplementation::GetPreferences(RPC::IStringIterator* const keys, IPreferenceIterator*& preferences, bool& success) {
+            Metrics::Scope metrics(_metrics, Metrics::GET_PREFERENCES);
+            std::list<Preference> values;
+            const uint32_t result = ReadPreferences(keys, values);
+            metrics.Result(result);
+            success = (Core::ERROR_NONE == result);
+            preferences = ((Core::ERROR_NONE == result) ? Core::Service<RPC::IteratorType<IPreferenceIterator>>::Create<IPreferenceIterator>(values) : nullptr);
+            return result;
+        }
+
+        Core::hresult UserPreferencesImplementation::SetPreferences(IPreferenceIterator* const preferences, RPC::IStringIterator*& failed, bool& success) {
+            Metrics::Scope metrics(_metrics, Metrics::SET_PREFERENCES);
+            std::list<string> refused;
+            const uint32_t result = WritePreferences(preferences, refused);
+            success = ((Core::ERROR_NONE == result) && refused.empty());
+            if (!success) {
+                metrics.Failed();
+            }
+            failed = ((Core::ERROR_NONE == result) ? Core::Service<RPC::StringIterator>::Create<RPC::IStringIterator>(refused) : nullptr);
+            return result;
+        }
+
+        Core::hresult UserPreferencesImplementation::IsContentAllowed(IContentIterator* const content, string& allowed, bool& success) {
+            Metrics::Scope metrics(_metrics, Metrics::IS_CONTENT_ALLOWED);
+            const uint32_t result = EvaluateContent(content, allowed);
+            metrics.Result(result);
+            success = (Core::ERROR_NONE == result);
+            return result;
+        }
+
+        Core::hresult UserPreferencesImplementation::SelectTracks(ITrackIterator* const tracks, int32_t& audio, int32_t& captions, bool& success) {
+            Metrics::Scope metrics(_metrics, Metrics::SELECT_TRACKS);
+            audio = -1;
+            captions = -1;
+            const uint32_t result = RankTracks(tracks, audio, captions);
+            metrics.Result(result);
+            success = (Core::ERROR_NONE == result);
+            return result;
+        }
+
+        /**
+        * @brief Reads the UI language, from the cache when it is valid.
+        * @param[out] uiLanguage  UI language in UserPreferences format (e.g., "US_en").
+        * @return Core::ERROR_NONE on success, Core::ERROR_GENERAL otherwise.
+        */
+        uint32_t UserPreferencesImplementation::ReadUILanguage(string& uiLanguage) {
+            // Fast path: the cache is fed by UserSettings notifications, so no COM traffic is needed.
+            // One snapshot, so the language and the migration state are consistent with each other
+            const StateSnapshot::View state = _state.Get();
+            if ((MigrationState::DONE == state.Migration()) && state.UILanguage(uiLanguage)) {
+                return Core::ERROR_NONE;
+            }
+
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings = RequestUserSettings();
+
+            if (!userSettings) {
+                // UserSettings is not up: answer with a queued value or from the legacy file
+                _pendingLock.Lock();
+                uiLanguage = _pendingUILanguage;
+                _pendingLock.Unlock();
+                if (!uiLanguage.empty() || ReadUILanguageFromFile(uiLanguage)) {
+                    LOGWARN("UserSettings not available, returning UI language '%s'", uiLanguage.c_str());
+                    return Core::ERROR_NONE;
+                }
+                LOGERR("Failed to get UserSettings interface");
+                return Core::ERROR_GENERAL;
+            }
+
+            if (!WaitForMigration()) {
+                LOGERR("Migration not completed; cannot get UI language");
+                return Core::ERROR_GENERAL;
+            }
+            
+            string presentationLanguage;
+            uint32_t status = GetPresentationLanguage(*userSettings, presentationLanguage);
+            if (Core::ERROR_NONE != status) {
+                LOGERR("Failed to get presentation language");
+                return Core::ERROR_GENERAL;
+            }
+            if (!ConvertToUserPrefsFormat(presentationLanguage, uiLanguage)) {
+                LOGERR("Failed to convert presentation language '%s' to UI format", presentationLanguage.c_str());
+                return Core::ERROR_GENERAL;
+            }
+            UpdateCachedUILanguage(uiLanguage);
+            // Optimization: the write-behind job updates the file only if language has changed
+            PersistUILanguage(uiLanguage);
+            return Core::ERROR_NONE;
+        }
+
+        /**
+        * @brief Sets the UI language in UserSettings, or queues it while UserSettings is not available.
+        * @param[in] uiLanguage  UI language in UserPreferences format (e.g., "US_en").
+        * @return Core::ERROR_NONE on success, Core::ERROR_GENERAL otherwise.
+        */
+        uint32_t UserPreferencesImplementation::WriteUILanguage(const string& uiLanguage) {
+            if (uiLanguage.empty()) {
+                LOGERR("No argument '%s'", SETTINGS_FILE_KEY);
+                return Core::ERROR_GENERAL;
+            }
+
+            // Codes are accepted in any case, but only the canonical form is cached or queued
+            string normalized;
+            string presentationLanguage;
+            if (!NormalizeUILanguage(uiLanguage, normalized, presentationLanguage)) {
+                return Core::ERROR_GENERAL;
+            }
+
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings = RequestUserSettings();
+        
+            if (!userSettings) {
+                // UserSettings is not up: queue the value, OnUserSettingsActivated() applies it
+                LOGWARN("UserSettings not available, queueing UI language '%s'", normalized.c_str());
+                _pendingLock.Lock();
+                _pendingUILanguage = normalized;
+                _pendingLock.Unlock();
+                return Core::ERROR_NONE;
+            }
+        
+            if (!WaitForMigration()) {
+                LOGERR("Migration not completed; cannot set UI language");
+                return Core::ERROR_GENERAL;
+            }
+
+            // Note: Need to keep the file in sync with UserSettings, but that will be handled
+            // in the callback from UserSettings, so not doing it here.
+        
+            uint32_t status = SetPresentationLanguage(*userSettings, presentationLanguage);
+        
+            if (Core::ERROR_NONE != status) {
+                LOGERR("Failed to set presentation language: %u", status);
+                return Core::ERROR_GENERAL;
+            }
+            // UserSettings now holds this value; don't serve a stale one until its notification arrives
+            UpdateCachedUILanguage(normalized);
+            return Core::ERROR_NONE;
+        }
+
+        /**
+        * @brief Reads several IUserSettings properties.
+        * @param[in]  keys    Property names (e.g., "captions", "voiceGuidanceRate"); all properties when empty.
+        * @param[out] values  The requested properties, in the order of keys.
+        */
+        uint32_t UserPreferencesImplementation::ReadPreferences(RPC::IStringIterator* const keys, std::list<Preference>& values) {
+            std::vector<SettingsCache::Setting> settings;
+            if (keys != nullptr) {
+                string key;
+                while (keys->Next(key)) {
+                    SettingsCache::Setting setting;
+                    if (!SettingsCache::Find(key, setting)) {
+                        LOGERR("Unknown preference '%s'", key.c_str());
+                        return Core::ERROR_GENERAL;
+                    }
+                    settings.push_back(setting);
+                }
+            }
+            if (settings.empty()) {
+                for (uint8_t index = 0; index < SettingsCache::SETTINGS; index++) {
+                    settings.push_back(static_cast<SettingsCache::Setting>(index));
+                }
+            }
+            return ReadSettings(settings, values);
+        }
+
+        /**
+        * @brief Gets the values of settings into values, in the same order. Values come from the
+        * notification-fed SettingsCache; only misses are read from UserSettings.
+        */
+        uint32_t UserPreferencesImplementation::ReadSettings(const std::vector<SettingsCache::Setting>& settings, std::list<Preference>& values) {
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings;
+            for (const SettingsCache::Setting setting : settings) {
+                JsonValue value;
+                if (!_settings.Get(setting, value)) {
+                    if (!userSettings) {
+                        userSettings = RequestUserSettings();
+                        if (!userSettings) {
+                            LOGERR("Failed to get UserSettings interface");
+                            return Core::ERROR_GENERAL;
+                        }
+                        if (!WaitForMigration()) {
+                            LOGERR("Migration not completed; cannot get preferences");
+                            return Core::ERROR_GENERAL;
+                        }
+                    }
+                    uint32_t status = SettingsCache::Fetch(*userSettings, setting, value);
+                    if (Core::ERROR_NONE != status) {
+                        LOGERR("Failed to get preference '%s': %u", SettingsCache::Key(setting), status);
+                        return Core::ERROR_GENERAL;
+                    }
+                    UpdateSetting(setting, value);
+                }
+                values.emplace_back();
+                SettingsCache::ToPreference(setting, value, values.back());
+            }
+            return Core::ERROR_NONE;
+        }
+
+        /**
+        * @brief Writes several IUserSettings properties.
+        * @param[in]  preferences  Property names and values (e.g., captions with enabled set).
+        * @param[out] failed       Names of the properties UserSettings refused.
+        * The whole batch is validated (names) before any of it is applied; each value is taken
+        * from the member of the property's type. "presentationLanguage" is the UI language in
+        * UserSettings format, so it is validated and applied like setUILanguage, which also
+        * updates the cached UI language.
+        */
+        uint32_t UserPreferencesImplementation::WritePreferences(IPreferenceIterator* const preferences, std::list<string>& failed) {
+            if (preferences == nullptr) {
+                LOGERR("No argument 'preferences'");
+                return Core::ERROR_GENERAL;
+            }
+
+            std::vector<std::pair<SettingsCache::Setting, JsonValue>> batch;
+            string uiLanguage;
+            Preference preference;
+            while (preferences->Next(preference)) {
+                SettingsCache::Setting setting;
+                if (!SettingsCache::Find(preference.key, setting)) {
+                    LOGERR("Unknown preference '%s'", preference.key.c_str());
+                    return Core::ERROR_GENERAL;
+                }
+                if (SettingsCache::PRESENTATION_LANGUAGE == setting) {
+                    string presentationLanguage;
+                    if (!ConvertToUserPrefsFormat(preference.text, uiLanguage)
+                        || !ConvertToUserSettingsFormat(uiLanguage, presentationLanguage)) {
+                        return Core::ERROR_GENERAL;
+                    }
+                    // In its canonical form, as setUILanguage would set it
+                    batch.emplace_back(setting, JsonValue(presentationLanguage));
+                    continue;
+                }
+                batch.emplace_back(setting, SettingsCache::FromPreference(setting, preference));
+            }
+            PluginInterfaceRef<Exchange::IUserSettings> userSettings = RequestUserSettings();
+            if (!userSettings) {
+                LOGERR("Failed to get UserSettings interface");
+                return Core::ERROR_GENERAL;
+            }
+            if (!WaitForMigration()) {
+                LOGERR("Migration not completed; cannot set preferences");
+                return Core::ERROR_GENERAL;
+            }
+
+            for (const std::pair<SettingsCache::Setting, JsonValue>& entry : batch) {
+                LOGINFO("%s: %s", SettingsCache::Key(entry.first), entry.second.String().c_str());
+                uint32_t status = ((SettingsCache::PRESENTATION_LANGUAGE == entry.first)
+                    ? WriteUILanguage(uiLanguage)
+                    : SettingsCache::Apply(*userSettings, entry.first, entry.second));
+                if (Core::ERROR_NONE == status) {
+                    // Write-through, the notification that follows confirms the value
+                    UpdateSetting(entry.first, entry.second);
+                } else {
+                    LOGERR("Failed to set preference '%s': %u", SettingsCache::Key(entry.first), status);
+                    failed.push_back(SettingsCache::Key(entry.first));
+                }
+            }
+            return Core::ERROR_NONE;
+        }
+
+        /**
+        * @brief Evaluates the parental control settings for a batch of content.
+        * @param[in]  content  The entries, each {scheme, rating, descriptorMask, airingTime}.
+        * @param[out] allowed  Bitmap in hex, bit n % 8 of byte n / 8 set when entry n may be shown.
+        * The settings are compiled into ViewingRestrictions as they change, so a batch is evaluated
+        * without any call to UserSettings once they are known. The entries are taken from the
+        * iterator as they are, without any parsing (see IsContentAllowedEpgGridCom in Tests/Benchmarks
+        * for the whole call).
+        */
+        uint32_t UserPreferencesImplementation::EvaluateContent(IContentIterator* const content, string& allowed) {
+            if (content == nullptr) {
+                LOGERR("No argument 'content'");
+                return Core::ERROR_GENERAL;
+            }
+
+            std::vector<Content> batch;
+            batch.reserve(content->Count());
+            Content entry;
+            while (content->Next(entry)) {
+                batch.push_back(std::move(entry));
+            }
+
+            if (!_restrictions.IsComplete()) {
+                // Primes the cache, which compiles the rules through UpdateSetting
+                std::list<Preference> values;
+                if (Core::ERROR_NONE != ReadSettings(ViewingRestrictions::Inputs(), values)) {
+                    LOGERR("Failed to get the viewing restrictions");
+                    return Core::ERROR_GENERAL;
+                }
+            }
+
+            std::vector<uint8_t> bitmap;
+            _restrictions.Evaluate(batch.data(), batch.size(), static_cast<int64_t>(::time(nullptr)), bitmap);
+
+            static const TCHAR hex[] = "0123456789abcdef";
+            allowed.clear();
+            allowed.reserve(bitmap.size() * 2);
+            for (const uint8_t byte : bitmap) {
+                allowed += hex[byte >> 4];
+                allowed += hex[byte & 0x0F];
+            }
+            return Core::ERROR_NONE;
+        }
+
+        /**
+        * @brief Picks the audio and caption tracks that best match the track preferences.
+        * @param[in]  tracks    The tracks, each {type, language, service, audioDescription}.
+        * @param[out] audio     Index of the audio track, -1 for none.
+        * @param[out] captions  Index of the caption track, -1 for none or when captions are off.
+        * The preferences are compiled into TrackPreferences as they change, so no list is parsed
+        * and UserSettings is not called once they are known.
+        */
+        uint32_t UserPreferencesImplementation::RankTracks(ITrackIterator* const tracks, int32_t& audio, int32_t& captions) {
+            if (tracks == nullptr) {
+                LOGERR("No argument 'tracks'");
+                return Core::ERROR_GENERAL;
+            }
+
+            std::vector<Track> candidates;
+            candidates.reserve(tracks->Count());
+            Track track;
+            while (tracks->Next(track)) {
+                candidates.push_back(std::move(track));
+            }
+
+            if (!_tracks.IsComplete()) {
+                // Primes the cache, which compiles the index through UpdateSetting
+                std::list<Preference> values;
+                if (Core::ERROR_NONE != ReadSettings(TrackPreferences::Inputs(), values)) {
+                    LOGERR("Failed to get the track preferences");
+                    return Core::ERROR_GENERAL;
+                }
+            }
+
+            const TrackPreferences::Selection selection = _tracks.Select(candidates.data(), candidates.size());
+            audio = selection.Audio;
+            captions = selection.Captions;
+            return Core::ERROR_NONE;
+        }
+
+        Core::hresult UserPreferencesImplementation::GetMetrics(string& metrics) {
+#ifdef USERPREFERENCES_METRICS
+            JsonObject probes;
+            for (uint8_t probe = 0; probe < Metrics::PROBES; probe++) {
+                const Metrics::Summary summary = _metrics.Get(static_cast<Metrics::Probe>(probe));
+                JsonObject entry;
+                entry["count"] = summary.Count;
+                entry["errors"] = summary.Errors;
+                entry["p50"] = summary.P50;
+                entry["p95"] = summary.P95;
+                entry["p99"] = summary.P99;
+                entry["max"] = summary.Max;
+                probes[Metrics::Name(static_cast<Metrics::Probe>(probe))] = entry;
+            }
+            probes.ToString(metrics);
+            return Core::ERROR_NONE;
+#else
+            return Core::ERROR_UNAVAILABLE;
+#endif
+        }
+
+        Core::hresult UserPreferencesImplementation::ResetMetrics() {
+#ifdef USERPREFERENCES_METRICS
+            _metrics.Reset();
+            return Core::ERROR_NONE;
+#else
+            return Core::ERROR_UNAVAILABLE;
+#endif
+        }
+        //End methods
+
+        //Begin events
+        void UserPreferencesImplementation::OnSettingChanged(const SettingsCache::Setting setting, const JsonValue& value) {
+            UpdateSetting(setting, value);
+        }
+
+        /**
+        * @brief Sends onUILanguageChanged with the last UI language reported by UserSettings, unless
+        * clients were already told about that value. Runs on the EventJob once a burst has settled.
+        */
+        void UserPreferencesImplementation::NotifyUILanguageChanged() {
+            string uiLanguage;
+            _eventLock.Lock();
+            uiLanguage.swap(_changedUILanguage);
+            _eventLock.Unlock();
+
+            // Only the EventJob touches _notifiedUILanguage, and it never runs concurrently with itself
+            if (uiLanguage.empty() || (uiLanguage == _notifiedUILanguage)) {
+                return;
+            }
+
+            LOGINFO("Notify %s %s", EVENT_ONUILANGUAGECHANGED, uiLanguage.c_str());
+            // The UserPreferences plugin is one of the clients, it sends the JSON-RPC event
+            _adminLock.Lock();
+            for (Exchange::IUserPreferences::INotification* client : _clients) {
+                client->OnUILanguageChanged(uiLanguage);
+            }
+            _adminLock.Unlock();
+            _notifiedUILanguage = std::move(uiLanguage);
+        }
+        //End events
+
+    } // namespace Plugin
+} // namespace WPEFramework
\ No newline at end of file
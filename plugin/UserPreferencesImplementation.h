@@ -0,0 +1,323 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2019 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include <interfaces/IConfiguration.h>
+#include <interfaces/IUserSettings.h>
+#include <interfaces/IUserPreferences.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <vector>
+#include "PluginInterfaceBuilder.h"
+#include "PreferenceStore.h"
+#include "Metrics.h"
+#include "SettingsCache.h"
+#include "SnapshotPublisher.h"
+#include "FileWatcher.h"
+#include "StateSnapshot.h"
+#include "ViewingRestrictions.h"
+#include "TrackPreferences.h"
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief The UserPreferences logic behind Exchange::IUserPreferences. Runs inside the Thunder
+        * host or in its own process, depending on the "root" mode of the plugin configuration; the
+        * UserPreferences plugin only forwards to it.
+        */
+        class UserPreferencesImplementation : public Exchange::IUserPreferences, public Exchange::IConfiguration {
+        private:
+
+            UserPreferencesImplementation(const UserPreferencesImplementation&) = delete;
+            UserPreferencesImplementation& operator=(const UserPreferencesImplementation&) = delete;
+
+            class Notification : public Exchange::IUserSettings::INotification
+                               , public PluginHost::IPlugin::INotification {
+                public:
+                    explicit Notification(UserPreferencesImplementation* parent) : _parent(parent) {}
+                    ~Notification() override = default;
+    
+                    void OnPresentationLanguageChanged(const string& language) override;
+                    void OnAudioDescriptionChanged(const bool enabled) override;
+                    void OnPreferredAudioLanguagesChanged(const string& preferredLanguages) override;
+                    void OnCaptionsChanged(const bool enabled) override;
+                    void OnPreferredCaptionsLanguagesChanged(const string& preferredLanguages) override;
+                    void OnPreferredClosedCaptionServiceChanged(const string& service) override;
+                    void OnPinControlChanged(const bool pinControl) override;
+                    void OnViewingRestrictionsChanged(const string& viewingRestrictions) override;
+                    void OnViewingRestrictionsWindowChanged(const string& viewingRestrictionsWindow) override;
+                    void OnLiveWatershedChanged(const bool liveWatershed) override;
+                    void OnPlaybackWatershedChanged(const bool playbackWatershed) override;
+                    void OnBlockNotRatedContentChanged(const bool blockNotRatedContent) override;
+                    void OnPinOnPurchaseChanged(const bool pinOnPurchase) override;
+                    void OnHighContrastChanged(const bool enabled) override;
+                    void OnVoiceGuidanceChanged(const bool enabled) override;
+                    void OnVoiceGuidanceRateChanged(const double rate) override;
+                    void OnVoiceGuidanceHintsChanged(const bool hints) override;
+
+                    void Activated(const string& callsign, PluginHost::IShell* plugin) override;
+                    void Deactivated(const string& callsign, PluginHost::IShell* plugin) override;
+                    void Unavailable(const string& callsign, PluginHost::IShell* plugin) override;
+    
+                private:
+                    UserPreferencesImplementation* _parent;
+    
+                    BEGIN_INTERFACE_MAP(Notification)
+                    INTERFACE_ENTRY(Exchange::IUserSettings::INotification)
+                    INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
+                    END_INTERFACE_MAP
+            };
+
+            class Config : public Core::JSON::Container {
+                public:
+                    Config(const Config&) = delete;
+                    Config& operator=(const Config&) = delete;
+
+                    Config()
+                        : Core::JSON::Container()
+                        , PersistDelay(500)
+                        , Path(_T("/opt/user_preferences.conf"))
+                        , Fsync(PreferenceStore::FsyncPolicy::DATA)
+                        , Snapshot()
+                    {
+                        Add(_T("persistdelay"), &PersistDelay);
+                        Add(_T("path"), &Path);
+                        Add(_T("fsync"), &Fsync);
+                        Add(_T("snapshot"), &Snapshot);
+                    }
+                    ~Config() override = default;
+
+                public:
+                    Core::JSON::DecUInt32 PersistDelay;   // Quiet period (ms) before a UI language change is written to the file
+                    Core::JSON::String Path;              // Legacy preferences file
+                    Core::JSON::EnumType<PreferenceStore::FsyncPolicy> Fsync;   // "none", "data" or "full"
+                    Core::JSON::String Snapshot;          // Shared memory snapshot for native readers, none when empty
+            };
+
+            using MigrationState = StateSnapshot::MigrationState;
+
+            /* Runs the migration on its own thread rather than on the WorkerPool: requests on pool
+            * threads wait for it, so a burst of them must not be able to keep it from running. */
+            class MigrationThread : public Core::Thread {
+                public:
+                    MigrationThread(const MigrationThread&) = delete;
+                    MigrationThread& operator=(const MigrationThread&) = delete;
+
+                    explicit MigrationThread(UserPreferencesImplementation& parent)
+                        : Core::Thread(Core::Thread::DefaultStackSize(), _T("UserPreferencesMigration"))
+                        , _parent(parent)
+                        , _submitted(false)
+                    {
+                    }
+                    ~MigrationThread() override
+                    {
+                        Revoke();
+                    }
+
+                    // Runs OnUserSettingsActivated() on the thread; one run covers any number of submits
+                    void Submit()
+                    {
+                        _submitted = true;
+                        Run();
+                    }
+                    // Waits for a running migration and stops the thread
+                    void Revoke()
+                    {
+                        Stop();
+                        Wait(Core::Thread::STOPPED, Core::infinite);
+                    }
+
+                private:
+                    uint32_t Worker() override
+                    {
+                        uint32_t delay = Core::infinite;
+                        if (_submitted.exchange(false)) {
+                            // Not infinite when the attempt failed and is to be retried after delay
+                            delay = _parent.OnUserSettingsActivated();
+                        }
+                        if (Core::infinite != delay) {
+                            _submitted = true;
+                        } else {
+                            Block();
+                            // Don't lose a Submit() that came in while running
+                            if (_submitted) {
+                                Run();
+                            }
+                        }
+                        return delay;
+                    }
+
+                private:
+                    UserPreferencesImplementation& _parent;
+                    std::atomic<bool> _submitted;
+            };
+
+            class PersistJob {
+                public:
+                    explicit PersistJob(UserPreferencesImplementation& parent) : _parent(parent) {}
+                    ~PersistJob() = default;
+
+                    void Dispatch() { _parent.FlushUILanguage(); }
+
+                private:
+                    UserPreferencesImplementation& _parent;
+            };
+
+            class ReconcileJob {
+                public:
+                    explicit ReconcileJob(UserPreferencesImplementation& parent) : _parent(parent) {}
+                    ~ReconcileJob() = default;
+
+                    void Dispatch() { _parent.ReconcileFile(); }
+
+                private:
+                    UserPreferencesImplementation& _parent;
+            };
+
+            class NotificationJob {
+                public:
+                    explicit NotificationJob(UserPreferencesImplementation& parent) : _parent(parent) {}
+                    ~NotificationJob() = default;
+
+                    void Dispatch() { _parent.DispatchSettingChanges(); }
+
+                private:
+                    UserPreferencesImplementation& _parent;
+            };
+
+            class EventJob {
+                public:
+                    explicit EventJob(UserPreferencesImplementation& parent) : _parent(parent) {}
+                    ~EventJob() = default;
+
+                    void Dispatch() { _parent.NotifyUILanguageChanged(); }
+
+                private:
+                    UserPreferencesImplementation& _parent;
+            };
+
+
+            private:
+            bool ConvertToUserSettingsFormat(const string& uiLanguage, string& presentationLanguage);
+            bool ConvertToUserPrefsFormat(const string& presentationLanguage, string& uiLanguage);
+            bool NormalizeUILanguage(const string& uiLanguage, string& normalized, string& presentationLanguage);
+            bool PerformMigration(Exchange::IUserSettings& userSettings);
+            bool WaitForMigration();
+            bool IsMigrationDone() const;
+            bool ReadUILanguageFromFile(string& uiLanguage) const;
+            void UpdateCachedUILanguage(const string& uiLanguage);
+            void InvalidateCachedUILanguage();
+            void UpdateSetting(const SettingsCache::Setting setting, const JsonValue& value);
+            void PersistUILanguage(const string& uiLanguage);
+            void FlushUILanguage();
+            void ReconcileFile();
+            uint32_t ReadUILanguage(string& uiLanguage);
+            uint32_t WriteUILanguage(const string& uiLanguage);
+            uint32_t ReadPreferences(RPC::IStringIterator* const keys, std::list<Preference>& values);
+            uint32_t ReadSettings(const std::vector<SettingsCache::Setting>& settings, std::list<Preference>& values);
+            uint32_t EvaluateContent(IContentIterator* const content, string& allowed);
+            uint32_t RankTracks(ITrackIterator* const tracks, int32_t& audio, int32_t& captions);
+            uint32_t WritePreferences(IPreferenceIterator* const preferences, std::list<string>& failed);
+            PluginInterfaceRef<Exchange::IUserSettings> RequestUserSettings();
+            PluginInterfaceRef<Exchange::IUserSettings> AcquireUserSettings();
+            uint32_t GetPresentationLanguage(Exchange::IUserSettings& userSettings, string& presentationLanguage);
+            uint32_t SetPresentationLanguage(Exchange::IUserSettings& userSettings, const string& presentationLanguage);
+            uint32_t SaveUILanguage(const string& uiLanguage);
+
+            //Begin events
+            void NotifyUILanguageChanged();
+            //End events
+
+        public:
+            UserPreferencesImplementation();
+            ~UserPreferencesImplementation() override;
+
+            // IConfiguration
+            uint32_t Configure(PluginHost::IShell* service) override;
+
+            // IUserPreferences
+            Core::hresult Register(Exchange::IUserPreferences::INotification* notification) override;
+            Core::hresult Unregister(Exchange::IUserPreferences::INotification* notification) override;
+            Core::hresult GetUILanguage(string& ui_language, bool& success) override;
+            Core::hresult SetUILanguage(const string& ui_language, bool& success) override;
+            Core::hresult GetPreferences(RPC::IStringIterator* const keys, IPreferenceIterator*& preferences, bool& success) override;
+            Core::hresult SetPreferences(IPreferenceIterator* const preferences, RPC::IStringIterator*& failed, bool& success) override;
+            Core::hresult IsContentAllowed(IContentIterator* const content, string& allowed, bool& success) override;
+            Core::hresult SelectTracks(ITrackIterator* const tracks, int32_t& audio, int32_t& captions, bool& success) override;
+            Core::hresult GetMetrics(string& metrics) override;
+            Core::hresult ResetMetrics() override;
+
+            BEGIN_INTERFACE_MAP(UserPreferencesImplementation)
+            INTERFACE_ENTRY(Exchange::IUserPreferences)
+            INTERFACE_ENTRY(Exchange::IConfiguration)
+            END_INTERFACE_MAP
+
+        private:
+            void QueueSettingChange(const SettingsCache::Setting setting, const JsonValue& value);
+            void DropSettingChanges();
+            void DispatchSettingChanges();
+            void OnPresentationLanguageChanged(const string& language);
+            void OnSettingChanged(const SettingsCache::Setting setting, const JsonValue& value);
+            void OnUserSettingsAvailable();
+            uint32_t OnUserSettingsActivated();
+            void OnUserSettingsDeactivated();
+            PluginHost::IShell* _service;
+            Core::Sink<Notification> _notification;
+            PluginInterfaceCache<Exchange::IUserSettings> _userSettings;
+            StateSnapshot _state;
+            std::atomic<uint8_t> _migrationAttempts;
+            Core::Event _migrationCompleted;
+            string _lastUILanguage;
+            PreferenceStore _store;
+            string _pendingUILanguage;
+            MigrationThread _migrationThread;
+            string _unsavedUILanguage;
+            uint32_t _persistDelayMs;
+            Core::CriticalSection _persistLock;
+            Core::WorkerPool::JobType<PersistJob> _persistJob;
+            Metrics::Registry _metrics;
+            string _changedUILanguage;
+            string _notifiedUILanguage;
+            Core::CriticalSection _eventLock;
+            Core::WorkerPool::JobType<EventJob> _eventJob;
+            SettingsCache _settings;
+            ViewingRestrictions _restrictions;
+            TrackPreferences _tracks;
+            SnapshotPublisher _snapshot;
+            FileWatcher _watcher;
+            Core::WorkerPool::JobType<ReconcileJob> _reconcileJob;
+            static_assert(SettingsCache::SETTINGS <= 32, "_changedMask has a bit per setting");
+            JsonValue _changedSettings[SettingsCache::SETTINGS];
+            uint32_t _changedMask;      // bit n set: _changedSettings[n] holds a change not handled yet
+            Core::CriticalSection _notificationLock;
+            Core::WorkerPool::JobType<NotificationJob> _notificationJob;
+            std::list<Exchange::IUserPreferences::INotification*> _clients;
+            mutable Core::CriticalSection _adminLock;
+            Core::CriticalSection _pendingLock;
+    
+        public:
+            static UserPreferencesImplementation* _instance;
+
+        };
+    } // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,315 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#include "ViewingRestrictions.h"
+#include "UtilsLogging.h"
+
+#include <cstdio>
+#include <ctime>
+#include <unordered_map>
+
+#define RESTRICTIONS_KEY                "restrictions"
+#define RESTRICTIONS_SCHEME             "scheme"
+#define RESTRICTIONS_RESTRICT           "restrict"
+#define RESTRICTIONS_WINDOW_ALWAYS      "ALWAYS"
+#define RESTRICTIONS_DESCRIPTOR_SEPARATOR '/'
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        struct ViewingRestrictions::Rules {
+            static constexpr uint32_t BLOCKED = ~static_cast<uint32_t>(0);
+
+            struct Scheme {
+                std::unordered_map<string, uint32_t> Ratings;       // rating -> ContentDescriptor bits that block it, BLOCKED for all content
+            };
+
+            Rules()
+                : Schemes()
+                , Enabled(false)
+                , BlockNotRated(false)
+                , LiveWatershed(false)
+                , PlaybackWatershed(false)
+                , Always(true)
+                , WindowStart(0)
+                , WindowEnd(0)
+            {
+            }
+
+            std::unordered_map<string, Scheme> Schemes;
+            bool Enabled;
+            bool BlockNotRated;
+            bool LiveWatershed;
+            bool PlaybackWatershed;
+            bool Always;
+            uint16_t WindowStart;       // minutes since local midnight
+            uint16_t WindowEnd;         // exclusive, before WindowStart when the window wraps midnight
+        };
+
+        constexpr uint32_t ViewingRestrictions::Rules::BLOCKED;
+        constexpr uint8_t ViewingRestrictions::INPUTS;
+
+        namespace {
+
+            // Index into ViewingRestrictions::_inputs, in the order of Inputs()
+            enum InputIndex : uint8_t {
+                PIN_CONTROL,
+                VIEWING_RESTRICTIONS,
+                VIEWING_RESTRICTIONS_WINDOW,
+                LIVE_WATERSHED,
+                PLAYBACK_WATERSHED,
+                BLOCK_NOT_RATED_CONTENT
+            };
+
+            bool ParseWindow(const string& window, uint16_t& start, uint16_t& end)
+            {
+                unsigned int startHours, startMinutes, endHours, endMinutes;
+                char trailing;
+                if ((::sscanf(window.c_str(), "%2u:%2u-%2u:%2u%c", &startHours, &startMinutes, &endHours, &endMinutes, &trailing) != 4)
+                    || (startHours > 23) || (endHours > 23) || (startMinutes > 59) || (endMinutes > 59)) {
+                    return false;
+                }
+                start = static_cast<uint16_t>((startHours * 60) + startMinutes);
+                end = static_cast<uint16_t>((endHours * 60) + endMinutes);
+                return true;
+            }
+
+            // The ContentDescriptor bit of a descriptor in viewingRestrictions, 0 for none
+            uint32_t DescriptorBit(const string& name)
+            {
+                static const struct {
+                    const TCHAR* Name;
+                    uint32_t Bit;
+                } descriptors[] = {
+                    { _T("D"), Exchange::IUserPreferences::DESCRIPTOR_DIALOGUE },
+                    { _T("L"), Exchange::IUserPreferences::DESCRIPTOR_LANGUAGE },
+                    { _T("S"), Exchange::IUserPreferences::DESCRIPTOR_SEXUAL_CONTENT },
+                    { _T("V"), Exchange::IUserPreferences::DESCRIPTOR_VIOLENCE },
+                    { _T("FV"), Exchange::IUserPreferences::DESCRIPTOR_FANTASY_VIOLENCE }
+                };
+                for (const auto& descriptor : descriptors) {
+                    if (name == descriptor.Name) {
+                        return descriptor.Bit;
+                    }
+                }
+                return 0;
+            }
+
+        } // namespace
+
+        ViewingRestrictions::ViewingRestrictions()
+            : _inputs()
+            , _known(0)
+            , _rules(Compile(_inputs, 0))
+            , _lock()
+        {
+        }
+
+        /* static */ const std::vector<SettingsCache::Setting>& ViewingRestrictions::Inputs()
+        {
+            // In the order of InputIndex
+            static const std::vector<SettingsCache::Setting> inputs = {
+                SettingsCache::PIN_CONTROL,
+                SettingsCache::VIEWING_RESTRICTIONS,
+                SettingsCache::VIEWING_RESTRICTIONS_WINDOW,
+                SettingsCache::LIVE_WATERSHED,
+                SettingsCache::PLAYBACK_WATERSHED,
+                SettingsCache::BLOCK_NOT_RATED_CONTENT
+            };
+            return inputs;
+        }
+
+        /* static */ int8_t ViewingRestrictions::IndexOf(const SettingsCache::Setting setting)
+        {
+            const std::vector<SettingsCache::Setting>& inputs = Inputs();
+            for (uint8_t index = 0; index < inputs.size(); index++) {
+                if (inputs[index] == setting) {
+                    return static_cast<int8_t>(index);
+                }
+            }
+            return -1;
+        }
+
+        void ViewingRestrictions::Update(const SettingsCache::Setting setting, const JsonValue& value)
+        {
+            const int8_t input = IndexOf(setting);
+            if (input < 0) {
+                return;
+            }
+            // Compiled under the lock so concurrent updates can't publish rules built from older inputs
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _inputs[input] = value;
+            _known |= (1u << input);
+            _rules = Compile(_inputs, _known);
+        }
+
+        void ViewingRestrictions::Invalidate()
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            _known = 0;
+            _rules = Compile(_inputs, 0);
+        }
+
+        bool ViewingRestrictions::IsComplete() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> lock(_lock);
+            return (_known == ((1u << INPUTS) - 1));
+        }
+
+        /* static */ std::shared_ptr<const ViewingRestrictions::Rules> ViewingRestrictions::Compile(const JsonValue inputs[], const uint8_t known)
+        {
+            std::shared_ptr<Rules> rules = std::make_shared<Rules>();
+            if ((known & (1u << PIN_CONTROL)) == 0) {
+                return rules;
+            }
+            rules->Enabled = inputs[PIN_CONTROL].Boolean();
+            rules->BlockNotRated = (((known & (1u << BLOCK_NOT_RATED_CONTENT)) != 0) && inputs[BLOCK_NOT_RATED_CONTENT].Boolean());
+            rules->LiveWatershed = (((known & (1u << LIVE_WATERSHED)) != 0) && inputs[LIVE_WATERSHED].Boolean());
+            rules->PlaybackWatershed = (((known & (1u << PLAYBACK_WATERSHED)) != 0) && inputs[PLAYBACK_WATERSHED].Boolean());
+
+            if ((known & (1u << VIEWING_RESTRICTIONS_WINDOW)) != 0) {
+                const string window = inputs[VIEWING_RESTRICTIONS_WINDOW].String();
+                if (!window.empty() && (window != RESTRICTIONS_WINDOW_ALWAYS)) {
+                    if (ParseWindow(window, rules->WindowStart, rules->WindowEnd)) {
+                        rules->Always = (rules->WindowStart == rules->WindowEnd);
+                    } else {
+                        // The restrictions then apply at any time, rather than never
+                        LOGWARN("Invalid viewing restrictions window '%s'", window.c_str());
+                    }
+                }
+            }
+            if ((known & (1u << VIEWING_RESTRICTIONS)) != 0) {
+                ParseRestrictions(inputs[VIEWING_RESTRICTIONS].String(), *rules);
+            }
+            return rules;
+        }
+
+        /* static */ void ViewingRestrictions::ParseRestrictions(const string& restrictions, Rules& rules)
+        {
+            JsonObject root;
+            if (restrictions.empty()) {
+                return;
+            }
+            if (!root.FromString(restrictions)) {
+                LOGERR("Invalid viewing restrictions '%s'", restrictions.c_str());
+                return;
+            }
+            JsonArray::Iterator entries = root[RESTRICTIONS_KEY].Array().Elements();
+            while (entries.Next()) {
+                JsonObject entry = entries.Current().Object();
+                Rules::Scheme& scheme = rules.Schemes[entry[RESTRICTIONS_SCHEME].String()];
+                JsonArray::Iterator restrict = entry[RESTRICTIONS_RESTRICT].Array().Elements();
+                while (restrict.Next()) {
+                    // "TV-14" blocks the rating, "TV-PG/V/L" only with any of the descriptors
+                    const string item = restrict.Current().String();
+                    const size_t separator = item.find(RESTRICTIONS_DESCRIPTOR_SEPARATOR);
+                    uint32_t& rating = scheme.Ratings[item.substr(0, separator)];
+                    if (string::npos == separator) {
+                        rating = Rules::BLOCKED;
+                        continue;
+                    }
+                    size_t begin = separator + 1;
+                    while (begin <= item.length()) {
+                        size_t end = item.find(RESTRICTIONS_DESCRIPTOR_SEPARATOR, begin);
+                        if (string::npos == end) {
+                            end = item.length();
+                        }
+                        const string descriptor = item.substr(begin, end - begin);
+                        begin = end + 1;
+                        if (descriptor.empty()) {
+                            continue;
+                        }
+                        const uint32_t bit = DescriptorBit(descriptor);
+                        if (bit == 0) {
+                            // No content can carry it; block the rating rather than miss one
+                            LOGWARN("Unknown content descriptor '%s', blocking '%s' outright", descriptor.c_str(), item.c_str());
+                            rating = Rules::BLOCKED;
+                            break;
+                        }
+                        rating |= bit;
+                    }
+                }
+            }
+        }
+
+        void ViewingRestrictions::Evaluate(const Content content[], const size_t count, const int64_t now, std::vector<uint8_t>& allowed) const
+        {
+            std::shared_ptr<const Rules> current;
+            _lock.Lock();
+            current = _rules;
+            _lock.Unlock();
+            const Rules& rules = *current;
+
+            allowed.assign((count + 7) / 8, 0);
+
+            // Local time of day by the UTC offset at now, rather than a localtime_r call per entry;
+            // airing times past a daylight saving change are off by its hour
+            int64_t offset = 0;
+            if (!rules.Always && (rules.LiveWatershed || rules.PlaybackWatershed)) {
+                const time_t seconds = static_cast<time_t>(now);
+                struct tm local;
+                if (::localtime_r(&seconds, &local) != nullptr) {
+                    offset = local.tm_gmtoff;
+                }
+            }
+
+            for (size_t index = 0; index < count; index++) {
+                if (IsAllowed(rules, content[index], now, offset)) {
+                    allowed[index / 8] |= static_cast<uint8_t>(1u << (index % 8));
+                }
+            }
+        }
+
+        /* static */ bool ViewingRestrictions::IsAllowed(const Rules& rules, const Content& content, const int64_t now, const int64_t offset)
+        {
+            if (!rules.Enabled) {
+                return true;
+            }
+
+            const bool live = (content.airingTime != 0);
+            if (!rules.Always && (live ? rules.LiveWatershed : rules.PlaybackWatershed)) {
+                const int64_t local = (live ? content.airingTime : now) + offset;
+                const uint16_t minute = static_cast<uint16_t>((((local % 86400) + 86400) % 86400) / 60);
+                const bool inWindow = (rules.WindowStart < rules.WindowEnd)
+                    ? ((minute >= rules.WindowStart) && (minute < rules.WindowEnd))
+                    : ((minute >= rules.WindowStart) || (minute < rules.WindowEnd));
+                if (!inWindow) {
+                    return true;
+                }
+            }
+
+            if (content.rating.empty()) {
+                return !rules.BlockNotRated;
+            }
+            std::unordered_map<string, Rules::Scheme>::const_iterator scheme = rules.Schemes.find(content.scheme);
+            if (scheme == rules.Schemes.end()) {
+                return true;
+            }
+            std::unordered_map<string, uint32_t>::const_iterator rating = scheme->second.Ratings.find(content.rating);
+            if (rating == scheme->second.Ratings.end()) {
+                return true;
+            }
+            if (rating->second == Rules::BLOCKED) {
+                return false;
+            }
+            return ((rating->second & content.descriptorMask) == 0);
+        }
+
+    } // namespace Plugin
+} // namespace WPEFramework
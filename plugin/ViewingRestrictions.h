@@ -0,0 +1,98 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+#include "Module.h"
+#include "SettingsCache.h"
+#include <memory>
+#include <vector>
+
+namespace WPEFramework {
+    namespace Plugin {
+
+        /**
+        * @brief The parental control settings of UserSettings compiled into rules that are cheap to
+        * evaluate in bulk, e.g. over an EPG grid.
+        *
+        * Built from pinControl, viewingRestrictions, viewingRestrictionsWindow, liveWatershed,
+        * playbackWatershed and blockNotRatedContent, and rebuilt whenever one of them changes.
+        * viewingRestrictions lists per rating scheme the ratings to block, optionally narrowed to
+        * content descriptors: {"restrictions": [{"scheme": "US_TV", "restrict": ["TV-14", "TV-PG/V"]}]}
+        * blocks TV-14 and TV-PG content with the V descriptor. Descriptors are the
+        * Exchange::IUserPreferences::ContentDescriptor bits, so the rule of a rating is a mask tested
+        * against the mask of the content; a rating narrowed to a descriptor without a bit is blocked
+        * outright rather than never.
+        *
+        * viewingRestrictionsWindow is "ALWAYS" (or empty) or a local time range "HH:MM-HH:MM", which
+        * may wrap midnight. liveWatershed limits the restrictions to the window for live content (an
+        * entry with an airing time), playbackWatershed for playback (no airing time, evaluated at the
+        * current time); without the flag they apply at any time. Nothing is restricted while
+        * pinControl is off.
+        *
+        * Evaluate() holds a reference to the current rules, so it takes no lock while evaluating and
+        * a rebuild never waits for it.
+        */
+        class ViewingRestrictions {
+        public:
+            // As passed to IUserPreferences::IsContentAllowed, so a batch is evaluated without copying it again
+            using Content = Exchange::IUserPreferences::Content;
+
+            ViewingRestrictions(const ViewingRestrictions&) = delete;
+            ViewingRestrictions& operator=(const ViewingRestrictions&) = delete;
+
+            ViewingRestrictions();
+            ~ViewingRestrictions() = default;
+
+            // The settings the rules are built from
+            static const std::vector<SettingsCache::Setting>& Inputs();
+
+            // Rebuilds the rules if setting is one of the inputs
+            void Update(const SettingsCache::Setting setting, const JsonValue& value);
+            // Forgets the inputs, e.g. when UserSettings goes away
+            void Invalidate();
+            // True once every input has a value; until then missing inputs count as off or empty
+            bool IsComplete() const;
+
+            /**
+            * @brief Evaluates count entries into allowed, a bitmap: bit n % 8 of byte n / 8 is set
+            * when content[n] may be shown.
+            * @param[in] now  Seconds since the epoch, the time playback entries are evaluated at.
+            */
+            void Evaluate(const Content content[], const size_t count, const int64_t now, std::vector<uint8_t>& allowed) const;
+
+        private:
+            struct Rules;
+
+            static constexpr uint8_t INPUTS = 6;
+
+            static int8_t IndexOf(const SettingsCache::Setting setting);
+            static std::shared_ptr<const Rules> Compile(const JsonValue inputs[], const uint8_t known);
+            static void ParseRestrictions(const string& restrictions, Rules& rules);
+            static bool IsAllowed(const Rules& rules, const Content& content, const int64_t now, const int64_t offset);
+
+        private:
+            JsonValue _inputs[INPUTS];
+            uint8_t _known;             // bit n set: _inputs[n] holds a value
+            std::shared_ptr<const Rules> _rules;
+            mutable Core::CriticalSection _lock;
+        };
+
+    } // namespace Plugin
+} // namespace WPEFramework
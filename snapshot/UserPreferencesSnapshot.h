@@ -0,0 +1,206 @@
+/**
+* If not stated otherwise in this file or this component's LICENSE
+* file the following copyright and licenses apply:
+*
+* Copyright 2026 RDK Management
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+**/
+
+#pragma once
+
+/**
+* Shared memory snapshot of the user preferences, for native processes that can't or don't want
+* to talk JSON-RPC. Header only, C++11, no Thunder dependency.
+*
+* The UserPreferences plugin maps a 64 byte file (USERPREFERENCES_SNAPSHOT_PATH by default) and
+* publishes the UI language, the presentation language and the accessibility settings into it,
+* guarded by a sequence counter (seqlock): odd while the plugin writes, incremented again when
+* done. A Reader maps the same file read only and copies the data out between two reads of the
+* counter, retrying when they differ, so reads take no lock and no system call. The counter
+* doubles as a version: a different even value means something changed.
+*
+*     UserPreferencesSnapshot::Reader snapshot;
+*     UserPreferencesSnapshot::Data data;
+*     if (snapshot.Read(data) && data.Has(UserPreferencesSnapshot::UI_LANGUAGE)) {
+*         use(data.UILanguage);    // "US_en"
+*     }
+*
+* The plugin keeps the file across restarts, so a mapping stays valid; fields it no longer
+* knows (e.g. while UserSettings is down) are reported as missing through Data::Valid.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef USERPREFERENCES_SNAPSHOT_PATH
+#define USERPREFERENCES_SNAPSHOT_PATH "/run/user_preferences.snapshot"
+#endif
+
+namespace UserPreferencesSnapshot {
+
+    static constexpr uint32_t MAGIC = 0x4E535055;      // "UPSN"
+    static constexpr uint16_t LAYOUT_VERSION = 1;
+
+    // Data::Valid bits: the members holding a value
+    enum Field : uint32_t {
+        UI_LANGUAGE = 0x0001,
+        PRESENTATION_LANGUAGE = 0x0002,
+        AUDIO_DESCRIPTION = 0x0004,
+        CAPTIONS = 0x0008,
+        HIGH_CONTRAST = 0x0010,
+        VOICE_GUIDANCE = 0x0020,
+        VOICE_GUIDANCE_HINTS = 0x0040,
+        VOICE_GUIDANCE_RATE = 0x0080
+    };
+
+    struct Data {
+        uint32_t Valid;                     // Field bits
+        uint32_t Flags;                     // Field bits of the boolean settings that are on
+        double VoiceGuidanceRate;
+        char UILanguage[8];                 // "US_en", '\0' terminated
+        char PresentationLanguage[24];      // "en-US", '\0' terminated
+
+        bool Has(const Field field) const { return ((Valid & field) != 0); }
+        // False when off or unknown
+        bool IsOn(const Field field) const { return ((Valid & Flags & field) != 0); }
+    };
+
+    struct Layout {
+        std::atomic<uint32_t> Magic;        // MAGIC once the publisher initialised the file
+        uint16_t LayoutVersion;
+        uint16_t Size;                      // sizeof(Layout)
+        std::atomic<uint32_t> Sequence;     // odd while the publisher writes
+        uint32_t Reserved;
+        Data Payload;
+    };
+
+    static_assert(sizeof(Data) == 48, "Data is part of the file layout");
+    static_assert(sizeof(Layout) == 64, "Layout is the file layout, one cache line");
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "Layout is shared between processes, its atomics must be lock free");
+
+    // The payload is copied a word at a time with relaxed atomic accesses: free of data races for
+    // the language (and ThreadSanitizer), as cheap as a plain copy on every target we run on
+    static constexpr uint32_t PAYLOAD_WORDS = sizeof(Data) / sizeof(uint32_t);
+
+    inline void StoreWords(Data& destination, const Data& source)
+    {
+        uint32_t words[PAYLOAD_WORDS];
+        ::memcpy(words, &source, sizeof(Data));
+        uint32_t* target = reinterpret_cast<uint32_t*>(&destination);
+        for (uint32_t index = 0; index < PAYLOAD_WORDS; index++) {
+            __atomic_store_n(&target[index], words[index], __ATOMIC_RELAXED);
+        }
+    }
+
+    inline void LoadWords(Data& destination, const Data& source)
+    {
+        uint32_t words[PAYLOAD_WORDS];
+        const uint32_t* origin = reinterpret_cast<const uint32_t*>(&source);
+        for (uint32_t index = 0; index < PAYLOAD_WORDS; index++) {
+            words[index] = __atomic_load_n(&origin[index], __ATOMIC_RELAXED);
+        }
+        ::memcpy(&destination, words, sizeof(Data));
+    }
+
+    /**
+    * @brief Publisher side: stores data with the seqlock protocol. Publishers must serialise their calls.
+    */
+    inline void Store(Layout& layout, const Data& data)
+    {
+        const uint32_t sequence = layout.Sequence.load(std::memory_order_relaxed);
+        layout.Sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        StoreWords(layout.Payload, data);
+        layout.Sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+    * @brief Consistent copy of the data, false while the file is not initialised or after too many
+    * attempts overlapped a write (the publisher writes seldom and briefly, so that is not expected).
+    */
+    inline bool Load(const Layout& layout, Data& data, uint32_t* version = nullptr)
+    {
+        if ((layout.Magic.load(std::memory_order_acquire) != MAGIC) || (layout.LayoutVersion != LAYOUT_VERSION)) {
+            return false;
+        }
+        for (uint32_t attempt = 0; attempt < 1000; attempt++) {
+            const uint32_t before = layout.Sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                LoadWords(data, layout.Payload);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (layout.Sequence.load(std::memory_order_relaxed) == before) {
+                    if (version != nullptr) {
+                        *version = before;
+                    }
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+    * @brief Maps the snapshot file read only. Opening takes a few system calls, reading none.
+    */
+    class Reader {
+    public:
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        explicit Reader(const char* path = USERPREFERENCES_SNAPSHOT_PATH)
+            : _layout(nullptr)
+        {
+            const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd >= 0) {
+                struct stat status;
+                if ((::fstat(fd, &status) == 0) && (status.st_size >= static_cast<off_t>(sizeof(Layout)))) {
+                    void* address = ::mmap(nullptr, sizeof(Layout), PROT_READ, MAP_SHARED, fd, 0);
+                    if (address != MAP_FAILED) {
+                        _layout = static_cast<const Layout*>(address);
+                    }
+                }
+                ::close(fd);
+            }
+        }
+        ~Reader()
+        {
+            if (_layout != nullptr) {
+                ::munmap(const_cast<Layout*>(_layout), sizeof(Layout));
+            }
+        }
+
+        // False if the file does not exist (yet); construct a new Reader to retry
+        bool IsOpen() const { return (_layout != nullptr); }
+
+        // Even and stable while nothing changes; 0 when not open
+        uint32_t Version() const
+        {
+            return (_layout != nullptr ? (_layout->Sequence.load(std::memory_order_acquire) & ~static_cast<uint32_t>(1)) : 0);
+        }
+
+        bool Read(Data& data, uint32_t* version = nullptr) const
+        {
+            return ((_layout != nullptr) && Load(*_layout, data, version));
+        }
+
+    private:
+        const Layout* _layout;
+    };
+
+} // namespace UserPreferencesSnapshot